@@ -3,12 +3,15 @@
 #include <fstream>
 #include <string>
 #include <memory>
+#include <limits>
+#include <utility>
 
 #include <boost/program_options.hpp>
 
 #include "../../src/histogram.h"
 #include "../../src/describe.h"
 #include "../../src/common.h"
+#include "../../src/reservoir.h"
 
 namespace po = boost::program_options;
 
@@ -18,6 +21,7 @@ struct options_t
   std::string instr;
   bool horizontal;
   uint64_t width;
+  uint64_t sample;
 };
 
 void get_stats(const options_t& opt)
@@ -43,12 +47,41 @@ void get_stats(const options_t& opt)
   }
 
   // Read data
-  while (std::getline(*stream, line))
+  if (opt.sample > 0)
   {
-    data.push_back(std::stod(line));
+    // Lines which will not enter the reservoir are skipped without parsing
+    BS::reservoir_sample<double> rs(opt.sample);
+    while (stream->good())
+    {
+      uint64_t skip = rs.skip();
+      uint64_t skipped = 0;
+      // At the end of the input ignore() still succeeds, but reads nothing
+      while (skipped < skip &&
+             stream->ignore(std::numeric_limits<std::streamsize>::max(),
+                            '\n') &&
+             stream->gcount() > 0)
+      {
+        skipped++;
+      }
+      rs.discard(skipped);
+      if (skipped < skip || ! std::getline(*stream, line))
+      {
+        break;
+      }
+      rs.add(std::stod(line));
+    }
+    data = rs.sample();
+  }
+  else
+  {
+    while (std::getline(*stream, line))
+    {
+      data.push_back(std::stod(line));
+    }
   }
 
-  BS::desc_stats<double> stats(data);
+  // Hand the parsed buffer over rather than copying it
+  BS::desc_stats<double> stats(std::move(data));
 
   std::cout << "\n##################################\n"
             << "####### General statistics #######\n"
@@ -57,13 +90,16 @@ void get_stats(const options_t& opt)
   std::cout << "Min:" << '\t' << stats.min() << '\n';
   std::cout << "Max:" << '\t' << stats.max() << '\n';
   std::cout << "Mean:" << '\t' << stats.mean() << '\n';
-  std::cout << "Median:" << '\t' << stats.median() << '\n';
-  std::cout << "Q5:" << '\t' << stats.quantile(0.05) << '\n';
-  std::cout << "Q10:" << '\t' << stats.quantile(0.10) << '\n';
-  std::cout << "Q25:" << '\t' << stats.quantile(0.25) << '\n';
-  std::cout << "Q75:" << '\t' << stats.quantile(0.75) << '\n';
-  std::cout << "Q90:" << '\t' << stats.quantile(0.90) << '\n';
-  std::cout << "Q95:" << '\t' << stats.quantile(0.95) << '\n';
+  // One multi-select instead of sorting all data
+  std::vector<double> q = stats.quantiles({0.5, 0.05, 0.10, 0.25, 0.75, 0.90,
+                                           0.95});
+  std::cout << "Median:" << '\t' << q[0] << '\n';
+  std::cout << "Q5:" << '\t' << q[1] << '\n';
+  std::cout << "Q10:" << '\t' << q[2] << '\n';
+  std::cout << "Q25:" << '\t' << q[3] << '\n';
+  std::cout << "Q75:" << '\t' << q[4] << '\n';
+  std::cout << "Q90:" << '\t' << q[5] << '\n';
+  std::cout << "Q95:" << '\t' << q[6] << '\n';
 
   std::cout << "\n##################################\n"
             << "########### Histogram ############\n"
@@ -97,6 +133,9 @@ int main(int argc, char ** argv)
    "Histogram bar width/height")
   ("horizontal,H", po::bool_switch(&options.horizontal)->default_value(false),
    "Print horizontal histogram")
+  ("sample,s", po::value<uint64_t>(&options.sample)->default_value(0),
+   "Compute statistics on a uniform random sample of this many lines. 0 uses "
+   "all lines.")
   ;
 
   po::options_description req("Input");
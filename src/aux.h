@@ -25,13 +25,17 @@ constexpr double UB()
   return 1 - std::numeric_limits<double>::epsilon();
 }
 /**
-* @brief Generate a random double in the open unit interval using global statically
-* scoped instances.
+* @brief Generate a random double in the open unit interval using the calling
+* thread's engine.
+* @see thread_engine(), seed_random().
 */
 double global_uniform_unit_db();
 
 /**
-* @brief Generate a random double in the open unit interval using local scoping.
+* @brief Generate a random double in the open unit interval using the calling
+* thread's engine.
+*
+* Kept for compatibility, this is the same as `global_uniform_unit_db()`.
 */
 double local_uniform_unit_db();
 
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "bin_kernel.h"
+#include "reduce.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BS_BIN_X86
+#endif
+
+namespace BS {
+
+namespace {
+
+const double EPS = std::numeric_limits<double>::epsilon();
+
+void bins_scalar(const double * data, uint64_t n, double min, double max,
+                 double inv_step, const double * breaks, uint32_t bins,
+                 uint32_t * out)
+{
+  const double last = static_cast<double>(bins - 1);
+  for (uint64_t j = 0; j < n; j++)
+  {
+    double x = data[j];
+    out[j] = BIN_UNRESOLVED;
+    if (! (x >= min && x <= max))
+      continue;
+    double d = std::min(std::max((x - min) * inv_step, 0.0), last);
+    uint32_t i = static_cast<uint32_t>(d);
+    if (! (breaks[i] <= x))
+      continue;
+    if (i + 1 < bins)
+    {
+      double up = breaks[i + 1];
+      if (! (up - x > std::fabs(up) * EPS))
+        continue;
+    }
+    out[j] = i;
+  }
+}
+
+#ifdef BS_BIN_X86
+
+__attribute__((target("avx2")))
+void bins_avx2(const double * data, uint64_t n, double min, double max,
+               double inv_step, const double * breaks, uint32_t bins,
+               uint32_t * out)
+{
+  const __m256d vmin = _mm256_set1_pd(min);
+  const __m256d vmax = _mm256_set1_pd(max);
+  const __m256d vinv = _mm256_set1_pd(inv_step);
+  const __m256d vzero = _mm256_setzero_pd();
+  const __m256d vlast = _mm256_set1_pd(static_cast<double>(bins - 1));
+  const __m256d veps = _mm256_set1_pd(EPS);
+  const __m256d vabs =
+    _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m256d vall = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  const __m128i ilast = _mm_set1_epi32(static_cast<int>(bins - 1));
+  uint64_t j = 0;
+  for (; j + 4 <= n; j += 4)
+  {
+    __m256d x = _mm256_loadu_pd(data + j);
+    __m256d ok = _mm256_and_pd(_mm256_cmp_pd(x, vmin, _CMP_GE_OQ),
+                               _mm256_cmp_pd(x, vmax, _CMP_LE_OQ));
+    __m256d d = _mm256_mul_pd(_mm256_sub_pd(x, vmin), vinv);
+    d = _mm256_min_pd(_mm256_max_pd(d, vzero), vlast);
+    // NaN lanes are already rejected, give them a valid index for the gather
+    d = _mm256_and_pd(d, ok);
+    __m128i i = _mm256_cvttpd_epi32(d);
+    __m128i i1 = _mm_min_epi32(_mm_add_epi32(i, _mm_set1_epi32(1)), ilast);
+    // Masked gathers with a defined source, the plain ones start from an
+    // undefined register
+    __m256d lo = _mm256_mask_i32gather_pd(vzero, breaks, i, vall, 8);
+    __m256d up = _mm256_mask_i32gather_pd(vzero, breaks, i1, vall, 8);
+    __m256d is_last = _mm256_castsi256_pd(
+      _mm256_cvtepi32_epi64(_mm_cmpeq_epi32(i, ilast)));
+    __m256d below_up = _mm256_cmp_pd(_mm256_sub_pd(up, x),
+                                     _mm256_mul_pd(_mm256_and_pd(up, vabs),
+                                                   veps), _CMP_GT_OQ);
+    ok = _mm256_and_pd(ok, _mm256_cmp_pd(lo, x, _CMP_LE_OQ));
+    ok = _mm256_and_pd(ok, _mm256_or_pd(below_up, is_last));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), i);
+    int mask = _mm256_movemask_pd(ok);
+    if (mask != 0xF)
+    {
+      for (int l = 0; l < 4; l++)
+      {
+        if (! (mask & (1 << l)))
+          out[j + l] = BIN_UNRESOLVED;
+      }
+    }
+  }
+  bins_scalar(data + j, n - j, min, max, inv_step, breaks, bins, out + j);
+}
+
+#endif
+
+} // namespace
+
+void equal_width_bins(const double * data, uint64_t n, double min, double max,
+                      double inv_step, const double * breaks, uint32_t bins,
+                      uint32_t * out)
+{
+#ifdef BS_BIN_X86
+  if (best_simd_level() == simd_level::avx2)
+  {
+    bins_avx2(data, n, min, max, inv_step, breaks, bins, out);
+    return;
+  }
+#endif
+  bins_scalar(data, n, min, max, inv_step, breaks, bins, out);
+}
+
+} // namespace BS
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Marks values which the kernel could not bin, see equal_width_bins()
+#define BIN_UNRESOLVED 0xFFFFFFFFu
+
+namespace BS {
+
+/**
+* @brief Compute the bins of doubles in equal-width bins with SIMD.
+*
+* The bin of each value is guessed from `(x - min) * inv_step` and accepted
+* when `breaks[i] <= x` and `x` is more than an epsilon below `breaks[i + 1]`,
+* i.e. when it is provably the bin a binary search with `almost_lt_eq` would
+* give. Values out of `[min, max]`, NaNs and values within an epsilon of the
+* upper break get `BIN_UNRESOLVED` and must be binned exactly by the caller.
+* The AVX2 kernel is used when the CPU supports it, see `best_simd_level()`.
+* @param data A pointer to the data.
+* @param n The number of values in `data`.
+* @param min The lower bound of the histogram.
+* @param max The upper bound of the histogram.
+* @param inv_step The number of bins divided by `max - min`.
+* @param breaks The lower break of every bin.
+* @param bins The number of bins.
+* @param out A buffer with room for `n` bin indices.
+*/
+void equal_width_bins(const double * data, uint64_t n, double min, double max,
+                      double inv_step, const double * breaks, uint32_t bins,
+                      uint32_t * out);
+
+} // namespace BS
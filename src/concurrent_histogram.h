@@ -0,0 +1,150 @@
+#pragma once
+
+// Upper limit on the number of counter stripes, see concurrent_histogram
+#define CONCURRENT_HISTOGRAM_MAX_STRIPES 64
+// Counters per 64 byte cache line
+#define CONCURRENT_HISTOGRAM_LINE 8
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include "histogram.h"
+
+namespace BS {
+
+/**
+* @brief Histogram which many threads can add to at the same time.
+*
+* Counts are kept in several stripes of relaxed atomic counters, one set per
+* stripe with each stripe starting on its own cache line. Every thread adds to
+* the stripe picked for it on its first `add()`, so threads only share cache
+* lines when there are more threads than stripes. No locks are taken, and
+* `snapshot()` reads the counters while writers keep adding.
+*/
+template <typename T>
+class concurrent_histogram
+{
+public:
+  /**
+  * @brief Constructor defining bounds and number of bins.
+  * @param min The lower bound of the histogram data.
+  * @param max The upper bound of the histogram data.
+  * @param bins The number of bins.
+  * @param stripes The number of counter stripes, rounded up to a power of 2.
+  * `0` uses the number of hardware threads, up to
+  * `CONCURRENT_HISTOGRAM_MAX_STRIPES`.
+  */
+  concurrent_histogram(const T min, const T max, const uint32_t bins,
+                       uint32_t stripes = 0);
+  /**
+  * @brief Add a new data point with bounds checking. Thread safe.
+  * @param x The data point to add.
+  * @see histogram::add().
+  */
+  inline void add(const T& x)
+  {
+    _shape._check_bounds(x);
+    unsafe_add(x);
+  }
+  /**
+  * @brief Add a new data point without bounds checking. Thread safe.
+  * @param x The data point to add.
+  * @see histogram::unsafe_add().
+  */
+  inline void unsafe_add(const T& x)
+  {
+    uint64_t i = _stripe() * _stride + _shape._bin(x);
+    _counts[i].fetch_add(1, std::memory_order_relaxed);
+  }
+  /**
+  * @brief Copy the current counts into an ordinary histogram.
+  *
+  * Writers are not stopped. Every bin count lies between the values it had
+  * when the call started and when it returned, so all adds which completed
+  * before the call (in the calling thread or in a thread that was joined or
+  * otherwise synchronized with) are included, and adds running concurrently
+  * are either counted or not, but never partially. Successive snapshots never
+  * decrease.
+  * @return A histogram with the same breaks as this one.
+  */
+  histogram<T> snapshot() const;
+  /**
+  * @brief Get the number of bins.
+  * @return The number of bins.
+  */
+  inline uint32_t bins() const { return _shape.bins(); }
+  /**
+  * @brief Get the data minimum.
+  * @return The lower bound.
+  */
+  inline T min() const { return _shape.min(); }
+  /**
+  * @brief Get the data maximum.
+  * @return The upper bound.
+  */
+  inline T max() const { return _shape.max(); }
+  /**
+  * @brief Get the number of counter stripes.
+  * @return The number of stripes.
+  */
+  inline uint32_t stripes() const { return _stripes; }
+private:
+  inline uint64_t _stripe() const
+  {
+    // Threads take stripes in turn, the first time they add to any histogram
+    static std::atomic<uint32_t> next(0);
+    static thread_local uint32_t id =
+      next.fetch_add(1, std::memory_order_relaxed);
+    return id & (_stripes - 1);
+  }
+  //
+  // Holds the breaks, and bins values with its (read only) _bin()
+  histogram<T> _shape;
+  uint32_t _stripes;
+  // Counters per stripe, a whole number of cache lines
+  uint64_t _stride;
+  std::unique_ptr<std::atomic<uint64_t>[]> _storage;
+  // _storage aligned to a cache line
+  std::atomic<uint64_t> * _counts;
+};
+
+template <typename T>
+concurrent_histogram<T>::concurrent_histogram(const T min, const T max,
+                                              const uint32_t bins,
+                                              uint32_t stripes) :
+  _shape(min, max, bins)
+{
+  if (stripes == 0)
+    stripes = std::max(1u, std::thread::hardware_concurrency());
+  stripes = std::min<uint32_t>(stripes, CONCURRENT_HISTOGRAM_MAX_STRIPES);
+  _stripes = 1;
+  while (_stripes < stripes)
+    _stripes *= 2;
+  _stride = (static_cast<uint64_t>(bins) + CONCURRENT_HISTOGRAM_LINE - 1) /
+            CONCURRENT_HISTOGRAM_LINE * CONCURRENT_HISTOGRAM_LINE;
+  uint64_t n = _stripes * _stride + CONCURRENT_HISTOGRAM_LINE;
+  _storage.reset(new std::atomic<uint64_t>[n]);
+  for (uint64_t i = 0; i < n; i++)
+    _storage[i].store(0, std::memory_order_relaxed);
+  uint64_t line = CONCURRENT_HISTOGRAM_LINE * sizeof(std::atomic<uint64_t>);
+  uint64_t offset = reinterpret_cast<uintptr_t>(_storage.get()) % line;
+  _counts = _storage.get() +
+            (offset ? (line - offset) / sizeof(std::atomic<uint64_t>) : 0);
+}
+
+template <typename T>
+histogram<T> concurrent_histogram<T>::snapshot() const
+{
+  histogram<T> h(_shape);
+  for (uint32_t s = 0; s < _stripes; s++)
+  {
+    const std::atomic<uint64_t> * stripe = _counts + s * _stride;
+    for (uint32_t b = 0; b < h._bins; b++)
+      h._counts[b] += stripe[b].load(std::memory_order_relaxed);
+  }
+  return h;
+}
+
+} // namespace BS
@@ -0,0 +1,277 @@
+#pragma once
+
+// Largest value range kept as a dense array of counts (8 MiB)
+#define COUNT_TABLE_DENSE_MAX (1ULL << 20)
+// Ranges up to this size stay dense whatever the count, larger ones only while
+// they hold at most COUNT_TABLE_DENSE_RATIO slots per value counted
+#define COUNT_TABLE_DENSE_MIN (1ULL << 12)
+#define COUNT_TABLE_DENSE_RATIO 8
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace BS {
+
+/**
+* @brief Counts of integer values, with order statistics.
+*
+* Values are counted in a dense array while their range spans at most
+* `COUNT_TABLE_DENSE_MAX` values and is not much larger than the number of
+* values counted, and in a hash table otherwise. Memory is per
+* distinct value (or per value of the range) instead of per data point, which
+* suits data with many repeated values such as depths or lengths. Order
+* statistics use cumulative counts, built on the first query after an add.
+*/
+template <typename T>
+class count_table {
+  static_assert(std::is_integral<T>::value, "count_table needs integers");
+public:
+  /**
+  * @brief Empty constructor
+  */
+  inline count_table() : _total(0), _lo(0), _sparse_mode(false) {}
+  /**
+  * @brief Count a value.
+  * @param x The value.
+  * @param c The number of times to count it.
+  */
+  inline void add(T x, uint64_t c = 1);
+  /**
+  * @brief Add the counts of another table.
+  * @param other The table to merge.
+  */
+  inline void merge(const count_table& other);
+  /**
+  * @brief Retrieve the number of values counted.
+  * @return The total count.
+  */
+  inline uint64_t count() const { return _total; }
+  /**
+  * @brief Retrieve the number of distinct values.
+  * @return The number of distinct values.
+  */
+  inline uint64_t distinct() const;
+  /**
+  * @brief Retrieve the value of a given rank.
+  *
+  * Not safe to call from several threads after an add, since the cumulative
+  * counts are built on first use.
+  * @param i The 0-based rank, i.e. `at(0)` is the smallest value.
+  * @return The value.
+  */
+  inline T at(uint64_t i) const;
+  /**
+  * @brief Call `f(value, count)` for every distinct value in increasing order.
+  * @param f The function to call.
+  */
+  template <typename F>
+  inline void for_each(F f) const;
+  /**
+  * @brief Check if the counts are in a dense array.
+  * @return `true` when dense, `false` when in a hash table.
+  */
+  inline bool dense() const { return ! _sparse_mode; }
+  /**
+  * @brief Retrieve the memory held by the table.
+  * @return The approximate size of the counts and cumulative counts in bytes.
+  */
+  inline uint64_t memory_bytes() const;
+private:
+  // Order preserving map to unsigned keys
+  static inline uint64_t _key(T x)
+  {
+    return std::is_signed<T>::value ?
+      static_cast<uint64_t>(static_cast<int64_t>(x)) ^ (1ULL << 63) :
+      static_cast<uint64_t>(x);
+  }
+  static inline T _value(uint64_t k)
+  {
+    return std::is_signed<T>::value ?
+      static_cast<T>(static_cast<int64_t>(k ^ (1ULL << 63))) :
+      static_cast<T>(k);
+  }
+  inline void _grow(uint64_t k);
+  inline void _to_sparse();
+  inline void _build() const;
+  //
+  uint64_t _total;
+  // Dense counts of keys _lo, _lo + 1, ...
+  uint64_t _lo;
+  std::vector<uint64_t> _dense;
+  bool _sparse_mode;
+  std::unordered_map<uint64_t, uint64_t> _sparse;
+  // Sorted keys and cumulative counts, empty when out of date
+  mutable std::vector<std::pair<uint64_t, uint64_t>> _cum;
+};
+
+template <typename T>
+void count_table<T>::add(T x, uint64_t c)
+{
+  if (c == 0)
+    return;
+  uint64_t k = _key(x);
+  _cum.clear();
+  _total += c;
+  if (_sparse_mode)
+  {
+    _sparse[k] += c;
+    return;
+  }
+  if (_dense.empty())
+  {
+    _lo = k;
+    _dense.assign(1, 0);
+  }
+  else if (k < _lo || k - _lo >= _dense.size())
+  {
+    _grow(k);
+    if (_sparse_mode)
+    {
+      _sparse[k] += c;
+      return;
+    }
+  }
+  _dense[k - _lo] += c;
+}
+
+template <typename T>
+void count_table<T>::_grow(uint64_t k)
+{
+  uint64_t hi = _lo + _dense.size() - 1;
+  uint64_t need_lo = std::min(_lo, k);
+  uint64_t need_hi = std::max(hi, k);
+  uint64_t range = need_hi - need_lo;
+  if (range >= COUNT_TABLE_DENSE_MAX ||
+      (range >= COUNT_TABLE_DENSE_MIN &&
+       range / COUNT_TABLE_DENSE_RATIO >= _total))
+  {
+    _to_sparse();
+    return;
+  }
+  // At least double, so a run of new extremes costs amortized O(1)
+  uint64_t span = std::max(need_hi - need_lo + 1,
+                           std::min<uint64_t>(2 * _dense.size(),
+                                              COUNT_TABLE_DENSE_MAX));
+  uint64_t new_lo;
+  if (k < _lo)
+    new_lo = need_hi + 1 >= span ? need_hi + 1 - span : 0;
+  else
+    new_lo = _lo > std::numeric_limits<uint64_t>::max() - (span - 1) ?
+             std::numeric_limits<uint64_t>::max() - (span - 1) : _lo;
+  std::vector<uint64_t> grown(span, 0);
+  std::copy(_dense.begin(), _dense.end(), grown.begin() + (_lo - new_lo));
+  _dense.swap(grown);
+  _lo = new_lo;
+}
+
+template <typename T>
+void count_table<T>::_to_sparse()
+{
+  for (uint64_t i = 0; i < _dense.size(); i++)
+  {
+    if (_dense[i] > 0)
+      _sparse[_lo + i] = _dense[i];
+  }
+  std::vector<uint64_t>().swap(_dense);
+  _sparse_mode = true;
+}
+
+template <typename T>
+void count_table<T>::merge(const count_table& other)
+{
+  other.for_each([this](T x, uint64_t c) { add(x, c); });
+}
+
+template <typename T>
+uint64_t count_table<T>::distinct() const
+{
+  if (_sparse_mode)
+    return _sparse.size();
+  return std::count_if(_dense.begin(), _dense.end(),
+                       [](uint64_t c) { return c > 0; });
+}
+
+template <typename T>
+void count_table<T>::_build() const
+{
+  if (! _cum.empty() || _total == 0)
+    return;
+  uint64_t cum = 0;
+  if (_sparse_mode)
+  {
+    _cum.assign(_sparse.begin(), _sparse.end());
+    std::sort(_cum.begin(), _cum.end());
+    for (auto& p : _cum)
+    {
+      cum += p.second;
+      p.second = cum;
+    }
+    return;
+  }
+  for (uint64_t i = 0; i < _dense.size(); i++)
+  {
+    if (_dense[i] > 0)
+    {
+      cum += _dense[i];
+      _cum.push_back(std::make_pair(_lo + i, cum));
+    }
+  }
+}
+
+template <typename T>
+T count_table<T>::at(uint64_t i) const
+{
+  if (i >= _total)
+  {
+    throw std::runtime_error("[BS::count_table::at] Rank out of range");
+  }
+  _build();
+  // First value whose cumulative count exceeds the rank
+  auto it = std::upper_bound(_cum.begin(), _cum.end(), i,
+                             [](uint64_t r, const std::pair<uint64_t,
+                                                            uint64_t>& p)
+                             {
+                               return r < p.second;
+                             });
+  return _value(it->first);
+}
+
+template <typename T>
+template <typename F>
+void count_table<T>::for_each(F f) const
+{
+  if (_sparse_mode)
+  {
+    _build();
+    uint64_t prev = 0;
+    for (const auto& p : _cum)
+    {
+      f(_value(p.first), p.second - prev);
+      prev = p.second;
+    }
+    return;
+  }
+  for (uint64_t i = 0; i < _dense.size(); i++)
+  {
+    if (_dense[i] > 0)
+      f(_value(_lo + i), _dense[i]);
+  }
+}
+
+template <typename T>
+uint64_t count_table<T>::memory_bytes() const
+{
+  // Hash nodes hold a key, a count and a next pointer, plus a bucket pointer
+  uint64_t sparse = _sparse.size() * (2 * sizeof(uint64_t) + sizeof(void *)) +
+                    _sparse.bucket_count() * sizeof(void *);
+  return sizeof(*this) + _dense.capacity() * sizeof(uint64_t) + sparse +
+         _cum.capacity() * sizeof(std::pair<uint64_t, uint64_t>);
+}
+
+} // Namespace BS
@@ -1,142 +1,642 @@
 #pragma once
 
+// Sort with radix_sort from this many values on, measured with
+// test_radix_sort_speed (radix_sort already wins at a few thousand doubles,
+// this leaves small data to std::sort which needs no extra buffer)
+#define DESC_STATS_RADIX_MIN_N (1ULL << 14)
+
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <numeric>
+#include <queue>
+#include <stdexcept>
 #include "common.h"
+#include "count_table.h"
 #include "histogram.h"
+#include "moments.h"
+#include "radix_sort.h"
+#include "reduce.h"
+#include "skiplist.h"
+#include "tdigest.h"
 
 namespace BS {
+
+/**
+* @brief Storage modes of `desc_stats`.
+*/
+enum class stats_mode
+{
+  /** Keep all data, so order statistics such as quantiles are available. */
+  full,
+  /** Keep no data, only the one pass moments. O(1) memory. */
+  online,
+  /** Keep no data, answer quantiles approximately from a `tdigest`. */
+  sketch,
+  /**
+  * Keep all data in a `skiplist`, so adds and exact quantiles both take
+  * O(log n). Suits many queries between adds.
+  */
+  indexed,
+  /**
+  * Integer types only. Keep a `count_table` of the values, so memory is per
+  * distinct value and quantiles are exact.
+  */
+  counts
+};
+
 /**
 * @brief Generic descriptive statistics class for `double` values.
 * 
-* This class implements several descriptive stats for double values.
+* This class implements several descriptive stats for double values. Count,
+* sum, extremes and moments are accumulated in one pass as data is added and
+* never need the data to be sorted. Order statistics (quantiles, median) need
+* the data and are exact in `stats_mode::full`, `stats_mode::indexed` and
+* `stats_mode::counts`. In `stats_mode::sketch` they are estimated in bounded
+* memory.
+*
+* In `stats_mode::full` the data is kept as a sorted prefix followed by the
+* values added since the last order statistic. Only those are sorted and then
+* merged into the prefix, so interleaving adds and queries does not sort all
+* data every time.
+*
+* Integer types default to `stats_mode::counts`, which keeps one count per
+* distinct value instead of every value, see `default_mode()`. This suits
+* data with many repeated values, such as depths or lengths.
 */
 template <typename T>
 class desc_stats {
 public:
+  /**
+  * @brief The storage mode used unless one is given.
+  * @return `stats_mode::counts` for integer types, `stats_mode::full`
+  * otherwise.
+  */
+  static inline stats_mode default_mode()
+  {
+    return std::is_integral<T>::value ? stats_mode::counts : stats_mode::full;
+  }
   /**
   * @brief Empty constructor
+  * @param mode Wether to keep the data for order statistics.
+  * @param compression The accuracy of the quantile sketch in
+  * `stats_mode::sketch`, see `tdigest`.
   */
-  inline desc_stats();
+  inline desc_stats(stats_mode mode = default_mode(),
+                    double compression = 200);
   /**
-  * @brief Constructor from a vector.
+  * @brief Constructor from a vector, which is copied.
+  *
+  * Integer data is counted in `stats_mode::counts` rather than copied, see
+  * `default_mode()`.
   * @param data A vector<double> containing the data.
   * @param sorted Indicates wether `data` is sorted.
   */
-  inline desc_stats(std::vector<T>& data, bool sorted = false);
+  inline desc_stats(const std::vector<T>& data, bool sorted = false);
+  /**
+  * @brief Constructor from a vector in a given mode.
+  * @param data A vector<double> containing the data.
+  * @param mode The storage mode, see `stats_mode`.
+  */
+  inline desc_stats(const std::vector<T>& data, stats_mode mode);
+  /**
+  * @brief Constructor taking ownership of a vector, without a copy.
+  *
+  * Uses `default_mode()` like the copying constructor, so integer data is
+  * counted and the vector released.
+  * @param data A vector<double> containing the data, left empty.
+  * @param sorted Indicates wether `data` is sorted.
+  */
+  inline desc_stats(std::vector<T>&& data, bool sorted = false);
+  /**
+  * @brief Constructor taking ownership of a vector in a given mode.
+  *
+  * The vector is only kept in `stats_mode::full`, in the other modes its
+  * values are added and it is released.
+  * @param data A vector<double> containing the data, left empty.
+  * @param mode The storage mode, see `stats_mode`.
+  */
+  inline desc_stats(std::vector<T>&& data, stats_mode mode);
+  /**
+  * @brief Read-only view over sorted data owned by the caller.
+  *
+  * No data is copied, `data` must stay alive and unchanged while the object
+  * is used. Throws if `data` is not sorted. Data cannot be added to a view.
+  * @param data A pointer to the sorted data.
+  * @param n The number of values in `data`.
+  */
+  inline desc_stats(const T * data, uint64_t n);
+  /**
+  * @brief Mutable view over data owned by the caller.
+  *
+  * No data is copied, `data` is sorted or partially reordered in place by
+  * the order statistics, and must stay alive while the object is used. Data
+  * cannot be added to a view.
+  * @param data A pointer to the data.
+  * @param n The number of values in `data`.
+  * @param sorted Indicates wether `data` is sorted.
+  */
+  inline desc_stats(T * data, uint64_t n, bool sorted = false);
+  inline desc_stats(const desc_stats& other);
+  inline desc_stats(desc_stats&& other) = default;
+  inline desc_stats& operator=(const desc_stats& other);
+  inline desc_stats& operator=(desc_stats&& other) = default;
   /**
   * @brief Add a single data point.
   * @param data A double data point.
   *
-  * Note that adding data will invalidate the sort order and the underlying data
-  * structure will be sorted before returning any stats. It is always more 
+  * In `stats_mode::full` values added since the last order statistic are
+  * sorted and merged into the sorted data on the next one. It is always more
   * efficient to call the getters once all data is added.
   */
   inline void add(T data);
   /**
+  * @brief Merge the data and stats of another object into this one.
+  *
+  * Moments are combined in O(1), see `moments::merge()`. In
+  * `stats_mode::full`, if both objects are sorted the data is merged in linear
+  * time and stays sorted, otherwise it is appended. Digests are merged in
+  * `stats_mode::sketch`. Both objects must have the same mode.
+  * @param other The object to merge.
+  */
+  inline void merge(const desc_stats& other);
+  /**
+  * @brief Merge the data and stats of another object into this one.
+  * @param other The object to merge.
+  * @return This object.
+  */
+  inline desc_stats& operator+=(const desc_stats& other)
+  {
+    merge(other);
+    return *this;
+  }
+  /**
+  * @brief Merge several objects into one.
+  *
+  * In `stats_mode::full` every part is sorted if needed and the sorted runs
+  * are combined with a single k-way merge, so the result is sorted without
+  * sorting all the data again.
+  * @param parts The objects to merge, which must all have the same mode.
+  * @return The merged object.
+  */
+  static desc_stats merge(std::vector<desc_stats>& parts);
+  /**
+  * @brief Sort the data now rather than on the first order statistic.
+  *
+  * Useful to sort parts on worker threads before merging them.
+  * Throws unless in `stats_mode::full`.
+  */
+  inline void sort() { _update(); }
+  /**
   * @brief Retrieve the value at a given quantile.
+  *
+  * Throws in `stats_mode::online` and is approximate in `stats_mode::sketch`.
   * @param q The quantile as a fraction, e.g.: `0.5` for Q50.
   * @return The value of the data at the given quantile. 
   */
   inline double quantile(const double q);
   /**
+  * @brief Retrieve the values at several quantiles at once.
+  *
+  * Unless the data is already sorted, only the order statistics needed by the
+  * requested quantiles are placed with a recursive `nth_element` (multi-select),
+  * in expected O(n log k) for k quantiles instead of O(n log n) for a full
+  * sort. The values are the same as those of `quantile()`.
+  * Throws in `stats_mode::online` and is approximate in `stats_mode::sketch`.
+  * @param probs The quantiles as fractions, e.g.: `{0.25, 0.5, 0.75}`.
+  * @return The values of the data at the given quantiles, in the same order.
+  */
+  inline std::vector<double> quantiles(const std::vector<double>& probs);
+  /**
   * @brief Retrieve the sum of the data.
   * @return The sum of the data.
   */
-  inline T sum() { _update(); return _sum; }
+  inline T sum() const { return static_cast<T>(_moments.sum()); }
   /**
   * @brief Retrieve the min of the data.
   * @return The min of the data.
   */
-  inline T min() { _update(); return _min; }
+  inline T min() const { return _moments.min(); }
   /**
   * @brief Retrieve the max of the data.
   * @return The max of the data.
   */
-  inline T max() { _update(); return _max; }
+  inline T max() const { return _moments.max(); }
   /**
   * @brief Retrieve the mean of the data.
   * @return The mean of the data.
   */
-  inline double mean() { _update(); return _sum / static_cast<double>(_data.size()); }
+  inline double mean() const { return _moments.mean(); }
+  /**
+  * @brief Retrieve the sample variance of the data.
+  * @return The variance of the data.
+  */
+  inline double variance() const { return _moments.variance(); }
+  /**
+  * @brief Retrieve the sample standard deviation of the data.
+  * @return The standard deviation of the data.
+  */
+  inline double stddev() const { return _moments.stddev(); }
+  /**
+  * @brief Retrieve the skewness of the data.
+  * @return The skewness of the data.
+  */
+  inline double skewness() const { return _moments.skewness(); }
+  /**
+  * @brief Retrieve the excess kurtosis of the data.
+  * @return The excess kurtosis of the data.
+  */
+  inline double kurtosis() const { return _moments.kurtosis(); }
   /**
   * @brief Retrieve the median of the data.
+  *
+  * Throws in `stats_mode::online` and is approximate in `stats_mode::sketch`.
   * @return The median of the data.
   */
-  inline double median() { _update(); return quantile(0.5); }
+  inline double median() { return quantile(0.5); }
   /**
   * @brief Retrieve the magnitude of the data.
   * @return The magnitude of the data.
   */
-  inline uint64_t size() const { return _data.size(); }
+  inline uint64_t size() const { return _moments.count(); }
   inline uint64_t count() const { return size(); }
+  /**
+  * @brief Retrieve the storage mode.
+  * @return The storage mode.
+  */
+  inline stats_mode mode() const { return _mode; }
+  /**
+  * @brief Check if the object is a view over data owned by the caller.
+  * @return `true` for views, `false` otherwise.
+  */
+  inline bool is_view() const { return _view != nullptr; }
   template <typename U> friend class histogram;
 private:
+  void _check() const;
   void _update();
+  void _sort(T * data, uint64_t n, std::true_type);
+  void _sort(T * data, uint64_t n, std::false_type);
+  void _init_moments(std::true_type);
+  void _init_moments(std::false_type);
+  void _position(const double q, uint64_t& i0, double& frac) const;
+  double _interpolate(const double q) const;
+  void _select(std::vector<uint64_t>::const_iterator first,
+               std::vector<uint64_t>::const_iterator last,
+               uint64_t lo, uint64_t hi);
+  // The data, either owned in _data or viewed
+  inline T * _ptr() { return _view ? _view : _data.data(); }
+  inline const T * _ptr() const { return _view ? _view : _data.data(); }
+  inline uint64_t _len() const { return _view ? _view_n : _data.size(); }
+  inline bool _is_sorted() const { return _sorted_n == _len(); }
+  inline T _at(uint64_t i) const
+  {
+    if (_mode == stats_mode::counts)
+      return static_cast<T>(_table.at(i));
+    return _mode == stats_mode::indexed ? _index->at(i) : _ptr()[i];
+  }
+  // Calls f(value, count), once per distinct value in stats_mode::counts
+  template <typename F>
+  inline void _for_each(F f) const
+  {
+    if (_mode == stats_mode::indexed)
+    {
+      for (const T& x : *_index)
+        f(x, 1);
+      return;
+    }
+    if (_mode == stats_mode::counts)
+    {
+      _table.for_each([&f](counted_type x, uint64_t c)
+                      { f(static_cast<T>(x), c); });
+      return;
+    }
+    const T * data = _ptr();
+    for (uint64_t i = 0; i < _len(); i++)
+      f(data[i], 1);
+  }
   //
   std::vector<T> _data;
-  T _max;
-  T _min;
-  bool _sorted;
-  T _sum;
+  T * _view;
+  uint64_t _view_n;
+  // Length of the sorted prefix of the data
+  uint64_t _sorted_n;
+  stats_mode _mode;
+  moments<T> _moments;
+  tdigest _digest;
+  // Only allocated in stats_mode::indexed
+  std::unique_ptr<skiplist<T>> _index;
+  // Only used for integers, the fallback type keeps other types compiling
+  typedef typename std::conditional<std::is_integral<T>::value, T,
+                                    int64_t>::type counted_type;
+  count_table<counted_type> _table;
 };
 
 template <typename T>
-desc_stats<T>::desc_stats() : _max(-std::numeric_limits<T>::infinity()),
-  _min(std::numeric_limits<T>::infinity()), _sorted(false), _sum(0) {}
+desc_stats<T>::desc_stats(stats_mode mode, double compression) :
+  _view(nullptr), _view_n(0), _sorted_n(0), _mode(mode),
+  _digest(compression)
+{
+  if (mode == stats_mode::counts && ! std::is_integral<T>::value)
+  {
+    throw std::runtime_error("[BS::desc_stats::desc_stats] Counts mode needs "
+                             "an integer type");
+  }
+  if (mode == stats_mode::indexed)
+    _index.reset(new skiplist<T>());
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(const desc_stats& other) :
+  _data(other._data), _view(other._view), _view_n(other._view_n),
+  _sorted_n(other._sorted_n), _mode(other._mode), _moments(other._moments),
+  _digest(other._digest),
+  _index(other._index ? new skiplist<T>(*other._index) : nullptr),
+  _table(other._table) {}
 
 template <typename T>
-desc_stats<T>::desc_stats(std::vector<T>& data, bool sorted) :
-  _max(-std::numeric_limits<T>::infinity()),
-  _min(std::numeric_limits<T>::infinity()), _sorted(false), _sum(0)
+desc_stats<T>& desc_stats<T>::operator=(const desc_stats& other)
+{
+  desc_stats copy(other);
+  *this = std::move(copy);
+  return *this;
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(const std::vector<T>& data, stats_mode mode) :
+  desc_stats(mode)
 {
   if (data.size() == 0)
   {
     throw std::runtime_error("[BS::desc_stats::desc_stats] Data vector length 0");
   }
-  if (sorted)
+  if (mode == stats_mode::full)
   {
-    for (T& d : data)
-    {
-      _data.push_back(d);
-      _sum += d;
-    }
-    _min = data[0];
-    _max = data[data.size() - 1];
-    _sorted = true;
+    _data = data;
+    _init_moments(std::is_same<T, double>());
+    return;
   }
-  else
+  for (const T& d : data)
+    add(d);
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(const std::vector<T>& data, bool sorted) :
+  desc_stats(data, default_mode())
+{
+  if (_mode == stats_mode::full && sorted)
+    _sorted_n = _data.size();
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(std::vector<T>&& data, stats_mode mode) :
+  desc_stats(mode)
+{
+  if (data.size() == 0)
   {
-    for (T& d : data)
-    {
-      _data.push_back(d);
-    }
-    _update();
+    throw std::runtime_error("[BS::desc_stats::desc_stats] Data vector length 0");
+  }
+  if (mode == stats_mode::full)
+  {
+    _data = std::move(data);
+    _init_moments(std::is_same<T, double>());
+    return;
+  }
+  for (const T& d : data)
+    add(d);
+  std::vector<T>().swap(data);
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(std::vector<T>&& data, bool sorted) :
+  desc_stats(std::move(data), default_mode())
+{
+  if (_mode == stats_mode::full && sorted)
+    _sorted_n = _data.size();
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(const T * data, uint64_t n) :
+  // Never written to since sorted data is never reordered
+  _view(const_cast<T *>(data)), _view_n(n), _sorted_n(n),
+  _mode(stats_mode::full)
+{
+  if (n == 0)
+  {
+    throw std::runtime_error("[BS::desc_stats::desc_stats] Data length 0");
+  }
+  if (! std::is_sorted(data, data + n))
+  {
+    throw std::runtime_error("[BS::desc_stats::desc_stats] Read-only data "
+                             "must be sorted");
+  }
+  _init_moments(std::is_same<T, double>());
+}
+
+template <typename T>
+desc_stats<T>::desc_stats(T * data, uint64_t n, bool sorted) :
+  _view(data), _view_n(n), _sorted_n(sorted ? n : 0),
+  _mode(stats_mode::full)
+{
+  if (n == 0)
+  {
+    throw std::runtime_error("[BS::desc_stats::desc_stats] Data length 0");
+  }
+  _init_moments(std::is_same<T, double>());
+}
+
+template <typename T>
+void desc_stats<T>::_init_moments(std::true_type /* double */)
+{
+  // One vectorized pass over all data
+  reduce_result r = reduce(_ptr(), _len());
+  _moments = moments<T>(r.count, r.sum(), r.mean(), r.central(2),
+                        r.central(3), r.central(4), r.min, r.max);
+}
+
+template <typename T>
+void desc_stats<T>::_init_moments(std::false_type /* other types */)
+{
+  const T * data = _ptr();
+  for (uint64_t i = 0; i < _len(); i++)
+    _moments.add(data[i]);
+}
+
+template <typename T>
+void desc_stats<T>::_check() const
+{
+  if (_mode == stats_mode::online || _mode == stats_mode::sketch)
+  {
+    throw std::runtime_error("[BS::desc_stats::_check] Data is only kept in "
+                             "full, indexed and counts modes");
+  }
+  if (size() == 0)
+  {
+    throw std::runtime_error("[BS::desc_stats::_check] No data");
   }
 }
 
 template <typename T>
 void desc_stats<T>::_update()
 {
-  if (! _sorted)
+  _check();
+  if (_mode != stats_mode::full || _is_sorted())
   {
-    std::sort(_data.begin(), _data.end());
-    _min = _data[0];
-    _max = _data[_data.size() - 1];
-    _sum = std::accumulate(_data.begin(), _data.end(), 0);
-    _sorted = true;
+    return;
   }
+  T * data = _ptr();
+  uint64_t n = _len();
+  // Sort only what was added after the sorted prefix, then merge
+  _sort(data + _sorted_n, n - _sorted_n, is_radix_sortable<T>());
+  if (_sorted_n > 0)
+    std::inplace_merge(data, data + _sorted_n, data + n);
+  _sorted_n = n;
+}
+
+template <typename T>
+void desc_stats<T>::_sort(T * data, uint64_t n,
+                          std::true_type /* radix sortable */)
+{
+  if (n >= DESC_STATS_RADIX_MIN_N)
+    radix_sort(data, n);
+  else
+    std::sort(data, data + n);
+}
+
+template <typename T>
+void desc_stats<T>::_sort(T * data, uint64_t n,
+                          std::false_type /* other types */)
+{
+  std::sort(data, data + n);
 }
 
 template <typename T>
 void desc_stats<T>::add(T data)
 {
+  if (is_view())
+  {
+    throw std::runtime_error("[BS::desc_stats::add] Cannot add data to a view");
+  }
+  _moments.add(data);
+  if (_mode == stats_mode::sketch)
+  {
+    _digest.add(static_cast<double>(data));
+    return;
+  }
+  if (_mode == stats_mode::online)
+  {
+    return;
+  }
+  if (_mode == stats_mode::indexed)
+  {
+    _index->insert(data);
+    return;
+  }
+  if (_mode == stats_mode::counts)
+  {
+    _table.add(static_cast<counted_type>(data));
+    return;
+  }
   _data.push_back(data);
-  if (_sorted)
+}
+
+template <typename T>
+void desc_stats<T>::merge(const desc_stats& other)
+{
+  if (other._mode != _mode)
+  {
+    throw std::runtime_error("[BS::desc_stats::merge] Cannot merge different "
+                             "modes");
+  }
+  if (is_view())
+  {
+    throw std::runtime_error("[BS::desc_stats::merge] Cannot merge into a "
+                             "view");
+  }
+  _moments.merge(other._moments);
+  if (_mode == stats_mode::sketch)
+  {
+    _digest.merge(other._digest);
+    return;
+  }
+  if (_mode == stats_mode::online)
+  {
+    return;
+  }
+  if (_mode == stats_mode::indexed)
+  {
+    for (const T& x : *other._index)
+      _index->insert(x);
+    return;
+  }
+  if (_mode == stats_mode::counts)
   {
-    _sorted = false;
+    _table.merge(other._table);
+    return;
   }
+  if (_is_sorted() && other._is_sorted())
+  {
+    std::vector<T> merged;
+    merged.reserve(_data.size() + other._len());
+    std::merge(_data.begin(), _data.end(), other._ptr(),
+               other._ptr() + other._len(), std::back_inserter(merged));
+    _data.swap(merged);
+    _sorted_n = _data.size();
+    return;
+  }
+  // The sorted prefix stays sorted
+  _data.insert(_data.end(), other._ptr(), other._ptr() + other._len());
+}
+
+template <typename T>
+desc_stats<T> desc_stats<T>::merge(std::vector<desc_stats>& parts)
+{
+  if (parts.empty())
+  {
+    throw std::runtime_error("[BS::desc_stats::merge] Nothing to merge");
+  }
+  stats_mode mode = parts[0]._mode;
+  desc_stats ret(mode, parts[0]._digest.compression());
+  if (mode != stats_mode::full)
+  {
+    for (auto& p : parts)
+      ret.merge(p);
+    return ret;
+  }
+  uint64_t total = 0;
+  for (auto& p : parts)
+  {
+    if (p._mode != mode)
+    {
+      throw std::runtime_error("[BS::desc_stats::merge] Cannot merge "
+                               "different modes");
+    }
+    ret._moments.merge(p._moments);
+    if (p._len() > 0)
+      p._update();
+    total += p._len();
+  }
+  // k-way merge of the sorted runs with a min-heap of run heads
+  typedef std::pair<T, uint64_t> head;
+  std::priority_queue<head, std::vector<head>, std::greater<head>> heap;
+  std::vector<uint64_t> pos(parts.size(), 0);
+  for (uint64_t i = 0; i < parts.size(); i++)
+  {
+    if (parts[i]._len() > 0)
+      heap.push(head(parts[i]._ptr()[0], i));
+  }
+  ret._data.reserve(total);
+  while (! heap.empty())
+  {
+    uint64_t i = heap.top().second;
+    ret._data.push_back(heap.top().first);
+    heap.pop();
+    if (++pos[i] < parts[i]._len())
+      heap.push(head(parts[i]._ptr()[pos[i]], i));
+  }
+  ret._sorted_n = total;
+  return ret;
 }
 
 template <typename T>
@@ -147,39 +647,116 @@ double desc_stats<T>::quantile(const double q)
     throw std::runtime_error("[BS::desc_stats::quantile]\t Probability must be"
                              "between 0 and 1");
   }
+  if (_mode == stats_mode::sketch)
+  {
+    return _digest.quantile(q);
+  }
   _update();
+  return _interpolate(q);
+}
+
+template <typename T>
+std::vector<double> desc_stats<T>::quantiles(const std::vector<double>& probs)
+{
+  for (double q : probs)
+  {
+    if (q < 0 || q > 1)
+    {
+      throw std::runtime_error("[BS::desc_stats::quantiles]\t Probability must "
+                               "be between 0 and 1");
+    }
+  }
+  std::vector<double> ret;
+  ret.reserve(probs.size());
+  if (_mode == stats_mode::sketch)
+  {
+    for (double q : probs)
+      ret.push_back(_digest.quantile(q));
+    return ret;
+  }
+  _check();
+  if (_mode == stats_mode::full && _sorted_n > 0)
+  {
+    // Cheaper to extend the sorted prefix than to select
+    _update();
+  }
+  if (_mode == stats_mode::full && ! _is_sorted())
+  {
+    // Order statistics needed by the interpolation, sorted and unique
+    std::vector<uint64_t> ranks;
+    ranks.reserve(2 * probs.size());
+    for (double q : probs)
+    {
+      uint64_t i0;
+      double frac;
+      _position(q, i0, frac);
+      ranks.push_back(i0);
+      if (frac > 0)
+        ranks.push_back(i0 + 1);
+    }
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    _select(ranks.begin(), ranks.end(), 0, _len());
+  }
+  for (double q : probs)
+    ret.push_back(_interpolate(q));
+  return ret;
+}
+
+template <typename T>
+void desc_stats<T>::_position(const double q, uint64_t& i0, double& frac) const
+{
+  frac = 0;
   // Some value sanity in extremities
   if (almost_eq<double>(q, 0))
   {
-    return _data[0];
+    i0 = 0;
+    return;
   }
   if (almost_eq<double>(q, 1))
   {
-    return _data[_data.size() - 1];
+    i0 = size() - 1;
+    return;
   }
   // Get index of probablities
-  double h = q * static_cast<double>(_data.size() - 1) + 1;
-  uint64_t i0;
-  if (q < 0)
+  double h = q * static_cast<double>(size() - 1) + 1;
+  i0 = std::trunc(h) - 1;
+  if (! almost_eq<double>(h, std::floor(h)))
   {
-    return static_cast<double>(_data[0]);
+    frac = h - std::floor(h);
   }
-  else if (q > 1)
-  {
-    return static_cast<double>(_data[_data.size() - 1]);
-  }
-  else if (almost_eq<double>(h, std::floor(h)))
+}
+
+template <typename T>
+double desc_stats<T>::_interpolate(const double q) const
+{
+  uint64_t i0;
+  double frac;
+  _position(q, i0, frac);
+  double xh = static_cast<double>(_at(i0));
+  if (frac == 0)
   {
-    i0 = std::trunc(h) - 1;
-    return static_cast<double>(_data[i0]);
+    return xh;
   }
-  else
+  double xh1 = static_cast<double>(_at(i0 + 1));
+  return xh + frac * (xh1 - xh);
+}
+
+template <typename T>
+void desc_stats<T>::_select(std::vector<uint64_t>::const_iterator first,
+                            std::vector<uint64_t>::const_iterator last,
+                            uint64_t lo, uint64_t hi)
+{
+  // Place the middle rank, then recurse on the ranks left of it and loop on
+  // those right of it. All ranks in [first, last) lie in [lo, hi).
+  while (first != last)
   {
-    i0 = std::trunc(h) - 1;
-    double xh = static_cast<double>(_data[i0]);
-    double xh1 = static_cast<double>(_data[i0 + 1]);
-    return xh + (h - std::floor(h)) * (xh1 - xh);
+    auto mid = first + (last - first) / 2;
+    std::nth_element(_ptr() + lo, _ptr() + *mid, _ptr() + hi);
+    _select(first, mid, lo, *mid);
+    lo = *mid + 1;
+    first = mid + 1;
   }
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <zlib.h>
+#include "fastq_sampler.h"
+#include "reservoir.h"
+#include "vitter_d.h"
+
+namespace BS {
+
+gz_chunk_reader::gz_chunk_reader(const std::string& path, uint64_t chunk_size,
+                                 uint32_t depth) :
+  _path(path), _gz(nullptr), _current(-1), _stop(false), _done(false)
+{
+  if (chunk_size == 0 || chunk_size > INT_MAX)
+    throw std::runtime_error("[BS::gz_chunk_reader::gz_chunk_reader] Chunk "
+                             "size must be in (0, INT_MAX]");
+  gzFile gz = gzopen(path.c_str(), "rb");
+  if (gz == nullptr)
+    throw std::runtime_error("[BS::gz_chunk_reader::gz_chunk_reader] Could not "
+                             "open file " + path);
+  gzbuffer(gz, 1 << 18);
+  _gz = gz;
+  // One buffer more than the read-ahead depth is held by the consumer
+  _buffers.resize(depth + 1, std::vector<char>(chunk_size));
+  _sizes.resize(depth + 1, 0);
+  for (uint32_t i = 0; i < depth + 1; i++)
+    _free.push_back(i);
+  _thread = std::thread(&gz_chunk_reader::_run, this);
+}
+
+gz_chunk_reader::~gz_chunk_reader()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  _thread.join();
+  gzclose(static_cast<gzFile>(_gz));
+}
+
+void gz_chunk_reader::_run()
+{
+  gzFile gz = static_cast<gzFile>(_gz);
+  while (true)
+  {
+    uint32_t idx;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this]() { return _stop || ! _free.empty(); });
+      if (_stop)
+        return;
+      idx = _free.front();
+      _free.pop_front();
+    }
+    std::vector<char>& buf = _buffers[idx];
+    int bytes = gzread(gz, buf.data(), static_cast<unsigned>(buf.size()));
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (bytes < 0)
+      {
+        int errnum;
+        _error = gzerror(gz, &errnum);
+        _done = true;
+      }
+      else if (bytes == 0)
+      {
+        _done = true;
+      }
+      else
+      {
+        _sizes[idx] = bytes;
+        _full.push_back(idx);
+      }
+    }
+    _cv.notify_all();
+    if (bytes <= 0)
+      return;
+  }
+}
+
+bool gz_chunk_reader::next(const char *& data, uint64_t& size)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_current >= 0)
+  {
+    _free.push_back(_current);
+    _current = -1;
+    _cv.notify_all();
+  }
+  _cv.wait(lock, [this]() { return ! _full.empty() || _done; });
+  if (! _full.empty())
+  {
+    _current = _full.front();
+    _full.pop_front();
+    data = _buffers[_current].data();
+    size = _sizes[_current];
+    return true;
+  }
+  if (! _error.empty())
+    throw std::runtime_error("[BS::gz_chunk_reader::next] Error reading " +
+                             _path + ": " + _error);
+  return false;
+}
+
+record_reader::record_reader(const std::string& path,
+                             uint32_t lines_per_record) :
+  _reader(path), _lines_per_record(lines_per_record), _pos(nullptr),
+  _end(nullptr), _eof(false)
+{
+  if (lines_per_record == 0)
+    throw std::runtime_error("[BS::record_reader::record_reader] Records "
+                             "must have at least one line");
+}
+
+bool record_reader::_refill()
+{
+  uint64_t size;
+  if (_eof || ! _reader.next(_pos, size))
+  {
+    _eof = true;
+    _pos = _end = nullptr;
+    return false;
+  }
+  _end = _pos + size;
+  return true;
+}
+
+uint64_t record_reader::skip(uint64_t count)
+{
+  uint64_t done = 0;
+  while (done < count)
+  {
+    for (uint32_t l = 0; l < _lines_per_record; l++)
+    {
+      // A last line without a newline still counts
+      bool partial = false;
+      while (true)
+      {
+        if (_pos == _end && ! _refill())
+        {
+          if (partial && l == _lines_per_record - 1)
+            return done + 1;
+          return done;
+        }
+        const char * nl =
+          static_cast<const char *>(memchr(_pos, '\n', _end - _pos));
+        if (nl != nullptr)
+        {
+          _pos = nl + 1;
+          break;
+        }
+        partial = true;
+        _pos = _end;
+      }
+    }
+    ++done;
+  }
+  return done;
+}
+
+bool record_reader::read(std::string& out)
+{
+  uint64_t start = out.size();
+  for (uint32_t l = 0; l < _lines_per_record; l++)
+  {
+    bool partial = false;
+    while (true)
+    {
+      if (_pos == _end && ! _refill())
+      {
+        if (partial && l == _lines_per_record - 1)
+        {
+          out += '\n';
+          return true;
+        }
+        out.resize(start);
+        return false;
+      }
+      const char * nl =
+        static_cast<const char *>(memchr(_pos, '\n', _end - _pos));
+      if (nl != nullptr)
+      {
+        out.append(_pos, nl + 1 - _pos);
+        _pos = nl + 1;
+        break;
+      }
+      out.append(_pos, _end - _pos);
+      partial = true;
+      _pos = _end;
+    }
+  }
+  return true;
+}
+
+fastq_sampler::fastq_sampler(const std::vector<std::string>& paths,
+                             uint32_t lines_per_record) :
+  _paths(paths), _lines_per_record(lines_per_record)
+{
+  if (paths.size() == 0)
+    throw std::runtime_error("[BS::fastq_sampler::fastq_sampler] No input "
+                             "files");
+}
+
+std::vector<std::unique_ptr<record_reader>> fastq_sampler::_open() const
+{
+  std::vector<std::unique_ptr<record_reader>> readers;
+  for (const auto& p : _paths)
+    readers.emplace_back(new record_reader(p, _lines_per_record));
+  return readers;
+}
+
+uint64_t fastq_sampler::sample(uint64_t n, uint64_t N,
+                               const std::vector<std::ostream*>& out)
+{
+  if (out.size() != _paths.size())
+    throw std::runtime_error("[BS::fastq_sampler::sample] Need one output per "
+                             "input file");
+  auto readers = _open();
+  vitter_d vd(N, n);
+  std::vector<uint64_t> buf(std::min<uint64_t>(std::max<uint64_t>(n, 1), 4096));
+  std::string rec;
+  uint64_t cur = 0;
+  uint64_t written = 0;
+  while (! vd.end())
+  {
+    uint64_t k = vd.fill(buf.data(), buf.size());
+    for (uint64_t i = 0; i < k; i++)
+    {
+      uint64_t skip = buf[i] - cur;
+      for (uint64_t f = 0; f < readers.size(); f++)
+      {
+        rec.clear();
+        if (readers[f]->skip(skip) != skip || ! readers[f]->read(rec))
+          throw std::runtime_error("[BS::fastq_sampler::sample] " + _paths[f] +
+                                   " has fewer than " + std::to_string(N) +
+                                   " records");
+        out[f]->write(rec.data(), rec.size());
+      }
+      cur = buf[i] + 1;
+      written++;
+    }
+  }
+  return written;
+}
+
+uint64_t fastq_sampler::sample(uint64_t n,
+                               const std::vector<std::ostream*>& out)
+{
+  if (out.size() != _paths.size())
+    throw std::runtime_error("[BS::fastq_sampler::sample] Need one output per "
+                             "input file");
+  typedef std::pair<uint64_t, std::vector<std::string>> entry_t;
+  auto readers = _open();
+  reservoir_sample<entry_t> rs(n);
+  entry_t entry(0, std::vector<std::string>(readers.size()));
+  uint64_t index = 0;
+  while (true)
+  {
+    uint64_t skip = rs.skip();
+    if (skip > 0)
+    {
+      uint64_t skipped = readers[0]->skip(skip);
+      for (uint64_t f = 1; f < readers.size(); f++)
+      {
+        if (readers[f]->skip(skip) != skipped)
+          throw std::runtime_error("[BS::fastq_sampler::sample] Input files "
+                                   "have different numbers of records");
+      }
+      rs.discard(skipped);
+      index += skipped;
+      if (skipped < skip)
+        break;
+      continue;
+    }
+    uint64_t complete = 0;
+    for (uint64_t f = 0; f < readers.size(); f++)
+    {
+      entry.second[f].clear();
+      if (readers[f]->read(entry.second[f]))
+        complete++;
+    }
+    if (complete == 0)
+      break;
+    if (complete != readers.size())
+      throw std::runtime_error("[BS::fastq_sampler::sample] Input files have "
+                               "different numbers of records");
+    entry.first = index++;
+    rs.add(entry);
+  }
+  std::vector<entry_t> samp = rs.sample();
+  std::sort(samp.begin(), samp.end(),
+            [](const entry_t& lhs, const entry_t& rhs)
+            {
+              return lhs.first < rhs.first;
+            });
+  for (const auto& e : samp)
+  {
+    for (uint64_t f = 0; f < out.size(); f++)
+      out[f]->write(e.second[f].data(), e.second[f].size());
+  }
+  return samp.size();
+}
+
+} // Namespace BS
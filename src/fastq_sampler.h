@@ -0,0 +1,143 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace BS {
+
+/**
+* @brief Read a (gzip compressed) file in chunks on a background thread.
+*
+* A reader thread decompresses into a small pool of fixed size buffers, which
+* the consumer takes in order and hands back when done. Plain files are read
+* as-is.
+*/
+class gz_chunk_reader {
+public:
+  /**
+  * @brief Open a file and start the reader thread.
+  * @param path The path to the file.
+  * @param chunk_size The size of each decompressed chunk in bytes.
+  * @param depth The number of chunks which may be decompressed ahead.
+  */
+  gz_chunk_reader(const std::string& path, uint64_t chunk_size = 1 << 20,
+                  uint32_t depth = 4);
+  ~gz_chunk_reader();
+  gz_chunk_reader(const gz_chunk_reader&) = delete;
+  gz_chunk_reader& operator=(const gz_chunk_reader&) = delete;
+  /**
+  * @brief Get the next chunk.
+  *
+  * The previous chunk is handed back to the reader thread and must not be
+  * used after this call.
+  * @param data Set to the start of the chunk.
+  * @param size Set to the size of the chunk.
+  * @return `false` at the end of the file, `true` otherwise.
+  */
+  bool next(const char *& data, uint64_t& size);
+private:
+  void _run();
+  //
+  std::string _path;
+  void * _gz;
+  std::vector<std::vector<char>> _buffers;
+  std::vector<uint64_t> _sizes;
+  std::deque<uint32_t> _full;
+  std::deque<uint32_t> _free;
+  int64_t _current;
+  bool _stop;
+  bool _done;
+  std::string _error;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::thread _thread;
+};
+
+/**
+* @brief Sequential access to fixed size groups of lines.
+*
+* Records are groups of `lines_per_record` lines, e.g. 4 for FASTQ. Skipping
+* only scans the chunks for newlines, so unselected records are never copied.
+*/
+class record_reader {
+public:
+  /**
+  * @brief Open a (gzip compressed) file.
+  * @param path The path to the file.
+  * @param lines_per_record The number of lines in each record.
+  */
+  record_reader(const std::string& path, uint32_t lines_per_record = 4);
+  /**
+  * @brief Skip records.
+  * @param count The number of records to skip.
+  * @return The number of records skipped, which is less than `count` only
+  * at the end of the file.
+  */
+  uint64_t skip(uint64_t count);
+  /**
+  * @brief Read one record.
+  * @param out The record, including its newlines, is appended to `out`.
+  * @return `false` if no complete record was left, `true` otherwise.
+  */
+  bool read(std::string& out);
+private:
+  bool _refill();
+  //
+  gz_chunk_reader _reader;
+  uint32_t _lines_per_record;
+  const char * _pos;
+  const char * _end;
+  bool _eof;
+};
+
+/**
+* @brief Subsampling of FASTQ (or other fixed size record) files.
+*
+* One or more files are read in lockstep, so that paired files (e.g. R1/R2)
+* keep the same records. Each file is decompressed on its own reader thread.
+* If the number of records is known, `vitter_d` selects the records; otherwise
+* `reservoir_sample` does. Either way unselected records are skipped by
+* scanning for newlines only.
+*/
+class fastq_sampler {
+public:
+  /**
+  * @brief Constructor.
+  * @param paths The input files, one per read of a pair.
+  * @param lines_per_record The number of lines in each record.
+  */
+  fastq_sampler(const std::vector<std::string>& paths,
+                uint32_t lines_per_record = 4);
+  /**
+  * @brief Sample records when the total number of records is known.
+  * @param n The sample size.
+  * @param N The number of records in each file.
+  * @param out One output stream per input file.
+  * @return The number of records written to each output.
+  */
+  uint64_t sample(uint64_t n, uint64_t N, const std::vector<std::ostream*>& out);
+  /**
+  * @brief Sample records from files of unknown length.
+  *
+  * The selected records are held in memory until the end of the input and
+  * then written in file order.
+  * @param n The sample size.
+  * @param out One output stream per input file.
+  * @return The number of records written to each output.
+  */
+  uint64_t sample(uint64_t n, const std::vector<std::ostream*>& out);
+private:
+  std::vector<std::unique_ptr<record_reader>> _open() const;
+  //
+  std::vector<std::string> _paths;
+  uint32_t _lines_per_record;
+};
+
+} // Namespace BS
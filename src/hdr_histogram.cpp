@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "hdr_histogram.h"
+
+namespace BS {
+
+hdr_histogram::hdr_histogram(uint64_t lowest, uint64_t highest,
+                             uint32_t digits) :
+  _lowest(lowest), _highest(highest), _digits(digits), _total(0),
+  _min(std::numeric_limits<uint64_t>::max()), _max(0)
+{
+  if (lowest < 1)
+    throw std::runtime_error("[BS::hdr_histogram::hdr_histogram] lowest must "
+                             "be at least 1");
+  if (highest < 2 || highest / 2 < lowest)
+    throw std::runtime_error("[BS::hdr_histogram::hdr_histogram] highest must "
+                             "be at least 2 * lowest");
+  if (digits < 1 || digits > 5)
+    throw std::runtime_error("[BS::hdr_histogram::hdr_histogram] digits must "
+                             "be between 1 and 5");
+  // Sub-buckets per bucket: enough for 1 unit steps up to 2 * 10^digits
+  uint64_t single_unit = 2;
+  for (uint32_t i = 0; i < digits; i++)
+    single_unit *= 10;
+  int32_t sub_bucket_magnitude = 64 - __builtin_clzll(single_unit - 1);
+  _sub_bucket_half_magnitude = sub_bucket_magnitude - 1;
+  uint64_t sub_bucket_count = 1ULL << sub_bucket_magnitude;
+  _sub_bucket_half_count = sub_bucket_count / 2;
+  _unit_magnitude = 63 - __builtin_clzll(lowest);
+  // The first bucket and the shifts of the value lookup must fit in 64 bits
+  if (_unit_magnitude + sub_bucket_magnitude > 61)
+    throw std::runtime_error("[BS::hdr_histogram::hdr_histogram] lowest is "
+                             "too large for the number of digits");
+  _sub_bucket_mask = (sub_bucket_count - 1) << _unit_magnitude;
+  // Buckets double the range covered until highest is included
+  int32_t buckets = 1;
+  int32_t range_magnitude = sub_bucket_magnitude + _unit_magnitude;
+  while (range_magnitude < 64 && (1ULL << range_magnitude) <= highest)
+  {
+    range_magnitude++;
+    buckets++;
+  }
+  _counts.assign((buckets + 1) * _sub_bucket_half_count, 0);
+}
+
+void hdr_histogram::_throw_too_large(uint64_t x) const
+{
+  throw std::runtime_error("[BS::hdr_histogram::add] Trying to add value " +
+                           std::to_string(x) + " greater than highest " +
+                           std::to_string(_highest) + " in the histogram");
+}
+
+uint64_t hdr_histogram::_value_at(uint64_t i) const
+{
+  int64_t bucket = static_cast<int64_t>(i >> _sub_bucket_half_magnitude) - 1;
+  uint64_t sub_bucket = (i & (_sub_bucket_half_count - 1)) +
+                        _sub_bucket_half_count;
+  if (bucket < 0)
+  {
+    sub_bucket -= _sub_bucket_half_count;
+    bucket = 0;
+  }
+  return sub_bucket << (bucket + _unit_magnitude);
+}
+
+uint64_t hdr_histogram::_bin_size(uint64_t i) const
+{
+  int64_t bucket = static_cast<int64_t>(i >> _sub_bucket_half_magnitude) - 1;
+  return 1ULL << (std::max<int64_t>(bucket, 0) + _unit_magnitude);
+}
+
+uint64_t hdr_histogram::lowest_equivalent(uint64_t x) const
+{
+  return _value_at(_index(x));
+}
+
+uint64_t hdr_histogram::highest_equivalent(uint64_t x) const
+{
+  uint64_t i = _index(x);
+  return _value_at(i) + (_bin_size(i) - 1);
+}
+
+void hdr_histogram::merge(const hdr_histogram& other)
+{
+  if (_lowest != other._lowest || _highest != other._highest ||
+      _digits != other._digits)
+    throw std::runtime_error("[BS::hdr_histogram::merge] Histograms have "
+                             "different parameters");
+  for (uint64_t i = 0; i < _counts.size(); i++)
+    _counts[i] += other._counts[i];
+  _total += other._total;
+  _min = std::min(_min, other._min);
+  _max = std::max(_max, other._max);
+}
+
+std::vector<uint64_t>
+hdr_histogram::quantiles(const std::vector<double>& probs) const
+{
+  if (_total == 0)
+    throw std::runtime_error("[BS::hdr_histogram::quantile] No data");
+  // Rank of the data point for each quantile, visited in increasing order
+  std::vector<uint64_t> ranks(probs.size());
+  for (uint64_t j = 0; j < probs.size(); j++)
+  {
+    double q = probs[j];
+    if (! (q >= 0 && q <= 1))
+      throw std::runtime_error("[BS::hdr_histogram::quantile] Probability "
+                               "must be between 0 and 1");
+    double r = std::ceil(q * static_cast<double>(_total));
+    ranks[j] = std::min(_total,
+                        std::max<uint64_t>(1, static_cast<uint64_t>(r)));
+  }
+  std::vector<uint64_t> order(probs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](uint64_t a, uint64_t b) { return ranks[a] < ranks[b]; });
+  std::vector<uint64_t> ret(probs.size());
+  uint64_t seen = 0;
+  uint64_t i = 0;
+  for (uint64_t j : order)
+  {
+    while (seen + _counts[i] < ranks[j])
+      seen += _counts[i++];
+    uint64_t x = _value_at(i) + (_bin_size(i) - 1);
+    ret[j] = std::max(_min, std::min(x, _max));
+  }
+  return ret;
+}
+
+uint64_t hdr_histogram::quantile(double q) const
+{
+  return quantiles(std::vector<double>(1, q))[0];
+}
+
+double hdr_histogram::mean() const
+{
+  if (_total == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  double sum = 0;
+  for (uint64_t i = 0; i < _counts.size(); i++)
+  {
+    if (_counts[i])
+    {
+      double mid = static_cast<double>(_value_at(i)) +
+                   static_cast<double>(_bin_size(i) / 2);
+      sum += mid * static_cast<double>(_counts[i]);
+    }
+  }
+  return sum / static_cast<double>(_total);
+}
+
+void hdr_histogram::print_tsv(std::ostream& out) const
+{
+  if (_total == 0)
+    return;
+  for (uint64_t i = _index(_min); i <= _index(_max); i++)
+  {
+    uint64_t lb = _value_at(i);
+    out << lb << '\t' << lb + _bin_size(i) << '\t' << _counts[i] << '\n';
+  }
+}
+
+} // namespace BS
@@ -1,22 +1,33 @@
 #pragma once
 
+// Bulk add: values binned per kernel call, and interleaved counters per bin
+#define HISTOGRAM_CHUNK 512
+#define HISTOGRAM_LANES 4
+
 #include <algorithm>
+#include <cmath>
 #include <vector>
 #include <limits>
 #include <cstdint>
 #include <ostream>
+#include "bin_kernel.h"
 #include "describe.h"
 #include "common.h"
 
 namespace BS {
 
 template <typename T> class desc_stats;
+template <typename T> class concurrent_histogram;
 
 /**
 * @brief Generic histogram class for `double` values.
 * 
 * This class implements a histogram class which counts doubles into equally
-* spaced bins. It uses a binary search algorithm to bin data.  
+* spaced bins. Bins are computed arithmetically from the bin width, with a
+* correction of at most a few steps against the breaks, so values on a break
+* land in the same bin as with a binary search over the breaks. The binary
+* search is only used when the breaks are not evenly spaced, e.g. when
+* `min == max` or when integer breaks are less than 1 apart.
 */
 template <typename T>
 class histogram 
@@ -73,6 +84,33 @@ class histogram
   */
   inline void unsafe_add(const T& x);
   /**
+  * @brief Add a range of data points with bounds checking.
+  *
+  * Bins are computed in chunks, with SIMD for `double` data, and counted in
+  * several interleaved counters per bin so that runs of values in the same
+  * bin do not wait on each other. The counts are the same as with `add()`
+  * for every value, but nothing is counted if a value is out of bounds.
+  * @param begin A pointer to the first data point.
+  * @param end A pointer past the last data point.
+  * @see add().
+  */
+  inline void add(const T * begin, const T * end);
+  /**
+  * @brief Add the counts of another histogram with the same breaks.
+  * @param other The histogram to merge into this one.
+  */
+  inline void merge(const histogram& other);
+  /**
+  * @brief Add the counts of another histogram with the same breaks.
+  * @param other The histogram to merge into this one.
+  * @return This object.
+  */
+  inline histogram& operator+=(const histogram& other)
+  {
+    merge(other);
+    return *this;
+  }
+  /**
   * @brief Get a reference to the histogram counts.
   * @return A const vector containing the counts for each bin.
   */
@@ -137,11 +175,21 @@ class histogram
   inline void print_tsv(std::ostream& out) const;
   inline void print_horizontal(std::ostream& out, uint64_t height = 30) const;
   private:
+  template <typename U> friend class concurrent_histogram;
   uint32_t _bin(const T& x);
+  uint32_t _search_bin(const T& x);
+  inline void _check_bounds(const T& x) const;
+  void _bin_chunk(const T * data, uint64_t n, uint32_t * out,
+                  std::true_type /* double */);
+  void _bin_chunk(const T * data, uint64_t n, uint32_t * out,
+                  std::false_type /* other types */);
   void _create_breaks();
   //
   uint32_t _bins;
   std::vector<T> _breaks;
+  // Evenly spaced breaks, binned with _inv_step
+  bool _regular;
+  double _inv_step;
   std::vector<uint64_t> _counts;
   T _max;
   T _min;
@@ -162,18 +210,19 @@ histogram<T>::histogram(const std::vector<T>& data, const T min,
 {
   _counts.resize(_bins, 0);
   _create_breaks();
-  for (auto& x : data)
-    add(x);
+  add(data.data(), data.data() + data.size());
 }
 
 template <typename T>
 histogram<T>::histogram(const std::vector<T>& data, const uint32_t bins,
                      const bool sorted) :
-  _bins(bins), _max(- std::numeric_limits<T>::infinity()),
-  _min(std::numeric_limits<T>::infinity())
+  _bins(bins)
 {
   if (data.size() == 0)
     throw std::runtime_error("[BS::histogram::histogram] data vector is empty");
+  // Not from infinity(), which is 0 for integers
+  _min = data[0];
+  _max = data[0];
   if (sorted)
   {
     _min = data.at(0);
@@ -189,20 +238,23 @@ histogram<T>::histogram(const std::vector<T>& data, const uint32_t bins,
   }
   _counts.resize(_bins, 0);
   _create_breaks();
-  for (auto& x : data)
-    add(x);
+  add(data.data(), data.data() + data.size());
 }
 
 template <typename T>
 histogram<T>::histogram(desc_stats<T>& stats, const uint32_t bins) : _bins(bins)
 {
-  stats._update();
-  _min = stats._data.at(0);
-  _max = stats._data.at(stats._data.size() - 1);
+  // No need to sort, the extremes are tracked as data is added
+  stats._check();
+  _min = stats.min();
+  _max = stats.max();
   _counts.resize(_bins, 0);
   _create_breaks();
-  for (auto& x : stats._data)
-    add(x);
+  stats._for_each([this](const T& x, uint64_t c)
+                  {
+                    _check_bounds(x);
+                    _counts[_bin(x)] += c;
+                  });
 }
 
 template <typename T>
@@ -217,10 +269,32 @@ void histogram<T>::_create_breaks()
     double di = static_cast<double>(i);
     _breaks.push_back(_min + static_cast<T>(step * di));
   }
+  _inv_step = nbins / (static_cast<double>(_max) - static_cast<double>(_min));
+  // Integer breaks less than 1 apart repeat, so a guess could be many bins off
+  _regular = std::isfinite(_inv_step) && _inv_step > 0 &&
+             (! std::numeric_limits<T>::is_integer || step >= 1);
 }
 
 template <typename T>
 uint32_t histogram<T>::_bin(const T& x)
+{
+  if (! _regular)
+    return _search_bin(x);
+  double d = (static_cast<double>(x) - static_cast<double>(_min)) * _inv_step;
+  int64_t last = static_cast<int64_t>(_bins) - 1;
+  // Written so that NaN guesses the first bin
+  int64_t i = d >= 0 ? (d < last ? static_cast<int64_t>(d) : last) : 0;
+  // Move to the last break almost less than or equal to x, as the binary
+  // search does. Values below all breaks go to the last bin like there.
+  while (i < last && almost_lt_eq<T>(_breaks[i + 1], x))
+    i++;
+  while (i >= 0 && ! almost_lt_eq<T>(_breaks[i], x))
+    i--;
+  return i < 0 ? _bins - 1 : static_cast<uint32_t>(i);
+}
+
+template <typename T>
+uint32_t histogram<T>::_search_bin(const T& x)
 {
   auto ptr = std::lower_bound(_breaks.begin(), _breaks.end(), x, almost_lt_eq<T>);
   uint32_t ind = std::distance(_breaks.begin(), ptr) - 1;
@@ -228,7 +302,7 @@ uint32_t histogram<T>::_bin(const T& x)
 }
 
 template <typename T>
-void histogram<T>::add(const T& x)
+void histogram<T>::_check_bounds(const T& x) const
 {
   if (! almost_lt_eq<T>(x, _max))
     throw std::runtime_error("[BS::histogram::add] Trying to add value " +
@@ -238,9 +312,77 @@ void histogram<T>::add(const T& x)
     throw std::runtime_error("[BS::histogram::add] Trying to add value "  +
                              std::to_string(x) + " less than min " +
                              std::to_string(_min) + " in the histogram");
+}
+
+template <typename T>
+void histogram<T>::add(const T& x)
+{
+  _check_bounds(x);
   _counts[_bin(x)]++;
 }
 
+template <typename T>
+void histogram<T>::add(const T * begin, const T * end)
+{
+  uint64_t n = end - begin;
+  // Interleaving only pays off with several values per bin
+  uint64_t lanes = n >= HISTOGRAM_LANES * static_cast<uint64_t>(_bins) ?
+                   HISTOGRAM_LANES : 1;
+  std::vector<uint64_t> counts(lanes * _bins, 0);
+  uint32_t idx[HISTOGRAM_CHUNK];
+  for (const T * chunk = begin; chunk < end; chunk += HISTOGRAM_CHUNK)
+  {
+    uint64_t m = std::min<uint64_t>(HISTOGRAM_CHUNK, end - chunk);
+    _bin_chunk(chunk, m, idx, std::is_same<T, double>());
+    for (uint64_t j = 0; j < m; j++)
+    {
+      uint32_t b = idx[j];
+      if (b == BIN_UNRESOLVED)
+      {
+        _check_bounds(chunk[j]);
+        b = _bin(chunk[j]);
+      }
+      counts[b * lanes + (j & (lanes - 1))]++;
+    }
+  }
+  for (uint32_t b = 0; b < _bins; b++)
+  {
+    for (uint64_t l = 0; l < lanes; l++)
+      _counts[b] += counts[b * lanes + l];
+  }
+}
+
+template <typename T>
+void histogram<T>::merge(const histogram& other)
+{
+  if (_bins != other._bins || _breaks != other._breaks || _max != other._max)
+    throw std::runtime_error("[BS::histogram::merge] Histograms have "
+                             "different breaks");
+  for (uint32_t i = 0; i < _bins; i++)
+    _counts[i] += other._counts[i];
+}
+
+template <typename T>
+void histogram<T>::_bin_chunk(const T * data, uint64_t n, uint32_t * out,
+                              std::true_type /* double */)
+{
+  if (! _regular)
+  {
+    std::fill(out, out + n, BIN_UNRESOLVED);
+    return;
+  }
+  equal_width_bins(data, n, _min, _max, _inv_step, _breaks.data(), _bins, out);
+}
+
+template <typename T>
+void histogram<T>::_bin_chunk(const T * /* data */, uint64_t n,
+                              uint32_t * out,
+                              std::false_type /* other types */)
+{
+  // Resolved one by one with bounds checks by the caller
+  std::fill(out, out + n, BIN_UNRESOLVED);
+}
+
 template <typename T>
 void histogram<T>::unsafe_add(const T& x)
 {
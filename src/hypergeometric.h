@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "random.h"
+
+namespace BS {
+
+namespace detail {
+
+// Inversion for small samples (algorithm HIN)
+template <typename URBG>
+uint64_t hypergeometric_hyp(URBG& rng, uint64_t good, uint64_t bad,
+                            uint64_t sample)
+{
+  double d1 = static_cast<double>(bad + good - sample);
+  double d2 = static_cast<double>(std::min(bad, good));
+  double Y = d2;
+  uint64_t K = sample;
+  while (Y > 0.0)
+  {
+    double U = uniform_open_unit(rng);
+    Y -= std::floor(U + Y / (d1 + static_cast<double>(K)));
+    --K;
+    if (K == 0)
+      break;
+  }
+  uint64_t Z = static_cast<uint64_t>(d2 - Y);
+  return good > bad ? sample - Z : Z;
+}
+
+// Ratio of uniforms (algorithm H2PE/HRUA) for large samples
+template <typename URBG>
+uint64_t hypergeometric_hrua(URBG& rng, uint64_t good, uint64_t bad,
+                             uint64_t sample)
+{
+  const double D1 = 1.7155277699214135;
+  const double D2 = 0.8989161620588988;
+  const double min_gb = static_cast<double>(std::min(good, bad));
+  const double max_gb = static_cast<double>(std::max(good, bad));
+  const uint64_t pop = good + bad;
+  const double popsize = static_cast<double>(pop);
+  const double m = static_cast<double>(std::min(sample, pop - sample));
+  const double d4 = min_gb / popsize;
+  const double d5 = 1.0 - d4;
+  const double d6 = m * d4 + 0.5;
+  const double d7 = std::sqrt((popsize - m) * static_cast<double>(sample) *
+                              d4 * d5 / (popsize - 1) + 0.5);
+  const double d8 = D1 * d7 + D2;
+  const double d9 = std::floor((m + 1) * (min_gb + 1) / (popsize + 2));
+  const double d10 = std::lgamma(d9 + 1) + std::lgamma(min_gb - d9 + 1) +
+                     std::lgamma(m - d9 + 1) +
+                     std::lgamma(max_gb - m + d9 + 1);
+  const double d11 = std::min(std::min(m, min_gb) + 1.0,
+                              std::floor(d6 + 16 * d7));
+  double Z;
+  while (true)
+  {
+    double X = uniform_open_unit(rng);
+    double Y = uniform_open_unit(rng);
+    double W = d6 + d8 * (Y - 0.5) / X;
+    // Fast rejection
+    if (W < 0.0 || W >= d11)
+      continue;
+    Z = std::floor(W);
+    double T = d10 - (std::lgamma(Z + 1) + std::lgamma(min_gb - Z + 1) +
+                      std::lgamma(m - Z + 1) +
+                      std::lgamma(max_gb - m + Z + 1));
+    // Fast acceptance
+    if ((X * (4.0 - X) - 3.0) <= T)
+      break;
+    // Fast rejection
+    if (X * (X - T) >= 1)
+      continue;
+    if (2.0 * std::log(X) <= T)
+      break;
+  }
+  uint64_t ret = static_cast<uint64_t>(Z);
+  if (good > bad)
+    ret = static_cast<uint64_t>(m) - ret;
+  if (static_cast<uint64_t>(m) < sample)
+    ret = good - ret;
+  return ret;
+}
+
+} // namespace detail
+
+/**
+* @brief Draw from the hypergeometric distribution.
+*
+* Returns the number of "good" items in a sample of `sample` items drawn
+* without replacement from `good + bad` items. Uses inversion for small samples
+* and the ratio of uniforms method by Stadlober (1989) otherwise, so the cost
+* does not grow with the population size.
+* @cite Stadlober1989
+* @param rng A UniformRandomBitGenerator.
+* @param good The number of good items.
+* @param bad The number of bad items.
+* @param sample The number of items drawn.
+* @return The number of good items in the sample.
+*/
+template <typename URBG>
+uint64_t hypergeometric(URBG& rng, uint64_t good, uint64_t bad,
+                        uint64_t sample)
+{
+  if (sample > good + bad)
+    throw std::runtime_error("[BS::hypergeometric] Sample larger than "
+                             "population");
+  if (sample == 0 || good == 0)
+    return 0;
+  if (bad == 0)
+    return sample;
+  if (sample > 10)
+    return detail::hypergeometric_hrua(rng, good, bad, sample);
+  return detail::hypergeometric_hyp(rng, good, bad, sample);
+}
+
+} // Namespace BS
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "line_sampler.h"
+#include "vitter_d.h"
+
+namespace BS {
+
+static const char LINE_INDEX_MAGIC[8] = {'B', 'S', 'L', 'I', 'D', 'X', '1', 0};
+
+line_sampler::line_sampler(const std::string& path, uint64_t stride) :
+  _data(nullptr), _size(0), _mtime(0), _stride(stride), _lines(0),
+  _indexed(false)
+{
+  if (stride == 0)
+    throw std::runtime_error("[BS::line_sampler::line_sampler] Index stride "
+                             "must be > 0");
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("[BS::line_sampler::line_sampler] Could not open "
+                             "file " + path);
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("[BS::line_sampler::line_sampler] Could not stat "
+                             "file " + path);
+  }
+  _size = st.st_size;
+  _mtime = st.st_mtime;
+  if (_size > 0)
+  {
+    void * map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+    {
+      close(fd);
+      throw std::runtime_error("[BS::line_sampler::line_sampler] Could not "
+                               "map file " + path);
+    }
+    _data = static_cast<const char *>(map);
+  }
+  close(fd);
+}
+
+line_sampler::~line_sampler()
+{
+  if (_data != nullptr)
+    munmap(const_cast<char *>(_data), _size);
+}
+
+void line_sampler::_build_index()
+{
+  _offsets.clear();
+  _lines = 0;
+  if (_size == 0)
+  {
+    _indexed = true;
+    return;
+  }
+  madvise(const_cast<char *>(_data), _size, MADV_SEQUENTIAL);
+  const char * pos = _data;
+  const char * end = _data + _size;
+  while (pos < end)
+  {
+    if (_lines % _stride == 0)
+      _offsets.push_back(pos - _data);
+    ++_lines;
+    const char * nl = static_cast<const char *>(memchr(pos, '\n', end - pos));
+    if (nl == nullptr)
+      break;
+    pos = nl + 1;
+  }
+  madvise(const_cast<char *>(_data), _size, MADV_NORMAL);
+  _indexed = true;
+}
+
+uint64_t line_sampler::lines()
+{
+  if (! _indexed)
+    _build_index();
+  return _lines;
+}
+
+const char * line_sampler::_skip_lines(const char * pos, uint64_t count) const
+{
+  const char * end = _data + _size;
+  for (uint64_t i = 0; i < count && pos < end; i++)
+  {
+    const char * nl = static_cast<const char *>(memchr(pos, '\n', end - pos));
+    pos = nl == nullptr ? end : nl + 1;
+  }
+  return pos;
+}
+
+line_view line_sampler::_view_at(const char * pos) const
+{
+  const char * end = _data + _size;
+  const char * nl = static_cast<const char *>(memchr(pos, '\n', end - pos));
+  line_view ret;
+  ret.data = pos;
+  ret.size = (nl == nullptr ? end : nl) - pos;
+  return ret;
+}
+
+line_view line_sampler::line(uint64_t i)
+{
+  if (i >= lines())
+    throw std::runtime_error("[BS::line_sampler::line] Line " +
+                             std::to_string(i) + " out of range for file with " +
+                             std::to_string(_lines) + " lines");
+  const char * pos = _data + _offsets[i / _stride];
+  return _view_at(_skip_lines(pos, i % _stride));
+}
+
+std::vector<line_view> line_sampler::sample(uint64_t n)
+{
+  vitter_d vd(lines(), n);
+  std::vector<line_view> ret;
+  ret.reserve(n);
+  std::vector<uint64_t> buf(std::min<uint64_t>(std::max<uint64_t>(n, 1), 4096));
+  const char * pos = _data;
+  uint64_t cur = 0;
+  while (! vd.end())
+  {
+    uint64_t k = vd.fill(buf.data(), buf.size());
+    for (uint64_t i = 0; i < k; i++)
+    {
+      uint64_t target = buf[i];
+      // Seek to the closest checkpoint if it lies past the current line
+      uint64_t checkpoint = target / _stride;
+      if (checkpoint > cur / _stride)
+      {
+        pos = _data + _offsets[checkpoint];
+        cur = checkpoint * _stride;
+      }
+      pos = _skip_lines(pos, target - cur);
+      cur = target;
+      ret.push_back(_view_at(pos));
+    }
+  }
+  return ret;
+}
+
+void line_sampler::save_index(const std::string& path)
+{
+  lines();
+  std::ofstream out(path.c_str(), std::ios::binary);
+  if (! out.good())
+    throw std::runtime_error("[BS::line_sampler::save_index] Could not open "
+                             "file " + path + " for writing");
+  uint64_t n_offsets = _offsets.size();
+  out.write(LINE_INDEX_MAGIC, sizeof(LINE_INDEX_MAGIC));
+  out.write(reinterpret_cast<const char *>(&_size), sizeof(_size));
+  out.write(reinterpret_cast<const char *>(&_mtime), sizeof(_mtime));
+  out.write(reinterpret_cast<const char *>(&_stride), sizeof(_stride));
+  out.write(reinterpret_cast<const char *>(&_lines), sizeof(_lines));
+  out.write(reinterpret_cast<const char *>(&n_offsets), sizeof(n_offsets));
+  out.write(reinterpret_cast<const char *>(_offsets.data()),
+            n_offsets * sizeof(uint64_t));
+  if (! out.good())
+    throw std::runtime_error("[BS::line_sampler::save_index] Failed writing "
+                             "index to " + path);
+}
+
+bool line_sampler::load_index(const std::string& path)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (! in.good())
+    return false;
+  char magic[sizeof(LINE_INDEX_MAGIC)];
+  uint64_t size;
+  int64_t mtime;
+  uint64_t stride;
+  uint64_t n_lines;
+  uint64_t n_offsets;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&size), sizeof(size));
+  in.read(reinterpret_cast<char *>(&mtime), sizeof(mtime));
+  in.read(reinterpret_cast<char *>(&stride), sizeof(stride));
+  in.read(reinterpret_cast<char *>(&n_lines), sizeof(n_lines));
+  in.read(reinterpret_cast<char *>(&n_offsets), sizeof(n_offsets));
+  if (! in.good() || memcmp(magic, LINE_INDEX_MAGIC, sizeof(magic)) != 0)
+    throw std::runtime_error("[BS::line_sampler::load_index] " + path +
+                             " is not a line index");
+  if (size != _size)
+    throw std::runtime_error("[BS::line_sampler::load_index] Index " + path +
+                             " was written for a file of " +
+                             std::to_string(size) + " bytes, not " +
+                             std::to_string(_size));
+  if (mtime != _mtime)
+    return false;
+  if (stride == 0 || n_lines > _size ||
+      n_offsets != (n_lines + stride - 1) / stride)
+    throw std::runtime_error("[BS::line_sampler::load_index] Corrupt header "
+                             "in index " + path);
+  std::vector<uint64_t> offsets(n_offsets);
+  in.read(reinterpret_cast<char *>(offsets.data()),
+          n_offsets * sizeof(uint64_t));
+  if (! in.good())
+    throw std::runtime_error("[BS::line_sampler::load_index] Truncated index " +
+                             path);
+  // Offsets are dereferenced in the mapping, so they must lie inside it
+  for (uint64_t i = 0; i < n_offsets; i++)
+  {
+    if (offsets[i] >= _size || (i > 0 && offsets[i] <= offsets[i - 1]))
+      throw std::runtime_error("[BS::line_sampler::load_index] Offset " +
+                               std::to_string(offsets[i]) + " in index " +
+                               path + " is out of order or past the end of "
+                               "the file");
+  }
+  _stride = stride;
+  _lines = n_lines;
+  _offsets.swap(offsets);
+  _indexed = true;
+  return true;
+}
+
+} // Namespace BS
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace BS {
+
+/**
+* @brief A non-owning view of a line inside a memory mapped file.
+*
+* The view does not include the line terminator and stays valid as long as the
+* `line_sampler` which produced it is alive.
+*/
+struct line_view
+{
+  const char * data;
+  uint64_t size;
+  /**
+  * @brief Copy the line into a string.
+  * @return The line as a string.
+  */
+  inline std::string str() const { return std::string(data, size); }
+};
+
+/**
+* @brief Random sampling of lines from a text file.
+*
+* The file is memory mapped and lines are located with `memchr`, so only the
+* newlines between selected records are looked at and nothing is copied. The
+* sample indices come from `vitter_d`.
+*
+* Counting the lines builds a sparse index holding the byte offset of every
+* `stride`-th line. The index lets sampling seek close to each selected
+* record, and it can be saved next to the file so that later samplings do not
+* need to count again.
+*/
+class line_sampler {
+public:
+  /**
+  * @brief Open and map a file.
+  * @param path The path to the file.
+  * @param stride The number of lines between two index checkpoints.
+  */
+  line_sampler(const std::string& path, uint64_t stride = 1024);
+  ~line_sampler();
+  line_sampler(const line_sampler&) = delete;
+  line_sampler& operator=(const line_sampler&) = delete;
+  /**
+  * @brief Get the number of lines in the file.
+  *
+  * The first call counts the lines and builds the index, unless an index was
+  * loaded with `load_index()`. A last line without a trailing newline is
+  * counted.
+  * @return The number of lines.
+  */
+  uint64_t lines();
+  /**
+  * @brief Get a single line.
+  * @param i The 0-based line number.
+  * @return A view of the line.
+  */
+  line_view line(uint64_t i);
+  /**
+  * @brief Sample lines uniformly without replacement.
+  * @param n The sample size.
+  * @return Views of the selected lines, in file order.
+  */
+  std::vector<line_view> sample(uint64_t n);
+  /**
+  * @brief Write the line index to a file.
+  *
+  * The index records the size and modification time of the mapped file, so
+  * that a stale index is rejected by `load_index()`.
+  * @param path The path of the index file.
+  */
+  void save_index(const std::string& path);
+  /**
+  * @brief Read a line index written by `save_index()`.
+  *
+  * Throws if the file is not a line index, was written for a file of another
+  * size, or holds offsets that are out of order or past the end of the
+  * mapped file.
+  * @param path The path of the index file.
+  * @return `true` if the index was loaded, `false` if it is missing or the
+  * mapped file was modified since the index was written.
+  */
+  bool load_index(const std::string& path);
+  /**
+  * @brief Get the size of the mapped file.
+  * @return The file size in bytes.
+  */
+  inline uint64_t size() const { return _size; }
+private:
+  void _build_index();
+  const char * _skip_lines(const char * pos, uint64_t count) const;
+  line_view _view_at(const char * pos) const;
+  //
+  const char * _data;
+  uint64_t _size;
+  int64_t _mtime;
+  uint64_t _stride;
+  uint64_t _lines;
+  bool _indexed;
+  // Byte offset of lines 0, stride, 2 * stride, ...
+  std::vector<uint64_t> _offsets;
+};
+
+} // Namespace BS
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace BS {
+
+/**
+* @brief One pass accumulator for count, sum, extremes and central moments.
+*
+* The moments are updated with the numerically stable recurrences of Welford
+* (1962) and Terriberry (2007), so no data needs to be kept. The sum is
+* compensated (Kahan-Babuska-Neumaier), also when merging, so its error does
+* not grow with the number of values.
+* @cite Welford1962
+* @cite Kahan1965
+*/
+template <typename T>
+class moments {
+public:
+  /**
+  * @brief Empty constructor
+  */
+  inline moments();
+  /**
+  * @brief Constructor from precomputed sums, e.g.: from `reduce()`.
+  * @param n The number of data points.
+  * @param sum The sum of the data.
+  * @param mean The mean of the data.
+  * @param M2 The sum of squared deviations from the mean.
+  * @param M3 The sum of cubed deviations from the mean.
+  * @param M4 The sum of deviations from the mean to the fourth power.
+  * @param min The min of the data.
+  * @param max The max of the data.
+  */
+  inline moments(uint64_t n, double sum, double mean, double M2, double M3,
+                 double M4, T min, T max) :
+    _n(n), _sum(sum), _sum_c(0), _mean(mean), _M2(M2), _M3(M3), _M4(M4),
+    _min(min), _max(max) {}
+  /**
+  * @brief Add a single data point.
+  * @param x The data point.
+  */
+  inline void add(T x);
+  /**
+  * @brief Combine with the moments of another data set.
+  *
+  * Uses the pairwise update of Chan et al. (1979), extended to the third and
+  * fourth moments by Pébay (2008), so the result is the same as adding all
+  * data to one accumulator up to rounding.
+  * @param other The moments to merge into this one.
+  * @cite Chan1979
+  */
+  inline void merge(const moments& other);
+  /**
+  * @brief Combine with the moments of another data set.
+  * @param other The moments to merge into this one.
+  * @return This object.
+  */
+  inline moments& operator+=(const moments& other)
+  {
+    merge(other);
+    return *this;
+  }
+  /**
+  * @brief Retrieve the number of data points.
+  * @return The number of data points.
+  */
+  inline uint64_t count() const { return _n; }
+  /**
+  * @brief Retrieve the sum of the data.
+  * @return The sum of the data.
+  */
+  inline double sum() const { return _sum + _sum_c; }
+  /**
+  * @brief Retrieve the min of the data.
+  * @return The min of the data.
+  */
+  inline T min() const { return _min; }
+  /**
+  * @brief Retrieve the max of the data.
+  * @return The max of the data.
+  */
+  inline T max() const { return _max; }
+  /**
+  * @brief Retrieve the mean of the data, from the compensated sum.
+  * @return The mean of the data.
+  */
+  inline double mean() const
+  {
+    return _n > 0 ? sum() / static_cast<double>(_n) : _mean;
+  }
+  /**
+  * @brief Retrieve the sample variance (with n - 1 in the denominator).
+  * @return The variance of the data.
+  */
+  inline double variance() const
+  {
+    return _n > 1 ? _M2 / static_cast<double>(_n - 1) :
+                    std::numeric_limits<double>::quiet_NaN();
+  }
+  /**
+  * @brief Retrieve the sample standard deviation.
+  * @return The standard deviation of the data.
+  */
+  inline double stddev() const { return std::sqrt(variance()); }
+  /**
+  * @brief Retrieve the skewness of the data.
+  * @return The (population) skewness of the data.
+  */
+  inline double skewness() const
+  {
+    return std::sqrt(static_cast<double>(_n)) * _M3 / std::pow(_M2, 1.5);
+  }
+  /**
+  * @brief Retrieve the excess kurtosis of the data.
+  * @return The (population) excess kurtosis of the data.
+  */
+  inline double kurtosis() const
+  {
+    return static_cast<double>(_n) * _M4 / (_M2 * _M2) - 3.0;
+  }
+private:
+  inline void _add_to_sum(double x);
+  //
+  uint64_t _n;
+  double _sum;
+  // Low order bits lost from _sum
+  double _sum_c;
+  double _mean;
+  double _M2;
+  double _M3;
+  double _M4;
+  T _min;
+  T _max;
+};
+
+template <typename T>
+moments<T>::moments() : _n(0), _sum(0), _sum_c(0), _mean(0), _M2(0), _M3(0),
+  _M4(0), _min(), _max() {}
+
+template <typename T>
+void moments<T>::_add_to_sum(double x)
+{
+  // Neumaier's variant of Kahan summation, which also holds when |x| > |sum|
+  double t = _sum + x;
+  if (std::fabs(_sum) >= std::fabs(x))
+    _sum_c += (_sum - t) + x;
+  else
+    _sum_c += (x - t) + _sum;
+  _sum = t;
+}
+
+template <typename T>
+void moments<T>::add(T x)
+{
+  if (_n == 0)
+  {
+    _min = x;
+    _max = x;
+  }
+  else
+  {
+    if (x < _min) _min = x;
+    if (x > _max) _max = x;
+  }
+  double xd = static_cast<double>(x);
+  double n1 = static_cast<double>(_n);
+  ++_n;
+  double n = static_cast<double>(_n);
+  double delta = xd - _mean;
+  double delta_n = delta / n;
+  double delta_n2 = delta_n * delta_n;
+  double term1 = delta * delta_n * n1;
+  _mean += delta_n;
+  _M4 += term1 * delta_n2 * (n * n - 3 * n + 3) + 6 * delta_n2 * _M2 -
+         4 * delta_n * _M3;
+  _M3 += term1 * delta_n * (n - 2) - 3 * delta_n * _M2;
+  _M2 += term1;
+  _add_to_sum(xd);
+}
+
+template <typename T>
+void moments<T>::merge(const moments& other)
+{
+  if (other._n == 0)
+  {
+    return;
+  }
+  if (_n == 0)
+  {
+    *this = other;
+    return;
+  }
+  if (other._min < _min) _min = other._min;
+  if (other._max > _max) _max = other._max;
+  double na = static_cast<double>(_n);
+  double nb = static_cast<double>(other._n);
+  double n = na + nb;
+  double delta = other._mean - _mean;
+  double delta2 = delta * delta;
+  double nanb = na * nb;
+  double M2 = _M2 + other._M2 + delta2 * nanb / n;
+  double M3 = _M3 + other._M3 + delta2 * delta * nanb * (na - nb) / (n * n) +
+              3 * delta * (na * other._M2 - nb * _M2) / n;
+  double M4 = _M4 + other._M4 +
+              delta2 * delta2 * nanb * (na * na - nanb + nb * nb) / (n * n * n) +
+              6 * delta2 * (na * na * other._M2 + nb * nb * _M2) / (n * n) +
+              4 * delta * (na * other._M3 - nb * _M3) / n;
+  _mean += delta * nb / n;
+  _M2 = M2;
+  _M3 = M3;
+  _M4 = M4;
+  _n += other._n;
+  _add_to_sum(other._sum);
+  _sum_c += other._sum_c;
+}
+
+} // namespace BS
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "hypergeometric.h"
+#include "parallel_sample.h"
+#include "random.h"
+#include "vitter_d.h"
+
+namespace BS {
+
+uint64_t parallel_sample(uint64_t N, uint64_t n, uint64_t * out,
+                         uint32_t threads)
+{
+  if (n > N)
+    throw std::runtime_error("Cannot sample more than population without "
+                             "replacement");
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (threads > N)
+    threads = std::max<uint64_t>(1, N);
+
+  // Contiguous ranges of (almost) equal size
+  std::vector<uint64_t> lo(threads);
+  std::vector<uint64_t> size(threads);
+  std::vector<uint64_t> count(threads);
+  std::vector<uint64_t> offset(threads);
+  std::vector<default_engine> engines;
+  engines.reserve(threads);
+
+  // Sequential conditional draws give the multivariate hypergeometric
+  // distribution of the range counts
+  default_engine rng = split_engine();
+  uint64_t pop_left = N;
+  uint64_t samp_left = n;
+  uint64_t start = 0;
+  uint64_t written = 0;
+  for (uint32_t t = 0; t < threads; t++)
+  {
+    lo[t] = start;
+    size[t] = N / threads + (t < N % threads ? 1 : 0);
+    count[t] = t == threads - 1 ? samp_left :
+      hypergeometric(rng, size[t], pop_left - size[t], samp_left);
+    offset[t] = written;
+    start += size[t];
+    pop_left -= size[t];
+    samp_left -= count[t];
+    written += count[t];
+    engines.push_back(split_engine());
+  }
+
+  auto worker = [&](uint32_t t)
+  {
+    basic_vitter_d<default_engine> vd(size[t], count[t], engines[t]);
+    uint64_t * slice = out + offset[t];
+    uint64_t k = vd.fill(slice, count[t]);
+    for (uint64_t i = 0; i < k; i++)
+    {
+      slice[i] += lo[t];
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (uint32_t t = 1; t < threads; t++)
+  {
+    pool.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto& th : pool)
+  {
+    th.join();
+  }
+  return written;
+}
+
+} // Namespace BS
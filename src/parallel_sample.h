@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace BS {
+
+/**
+* @brief Sample without replacement using several threads.
+*
+* The population is split into `threads` contiguous ranges. The number of
+* samples falling into each range is drawn from the multivariate
+* hypergeometric distribution, after which every range is sampled by its own
+* `vitter_d` on a worker thread. Each range writes into its own slice of `out`,
+* so the result is sorted and has the same distribution as sampling the whole
+* population sequentially.
+*
+* The range counts and worker engines are drawn on the calling thread, so the
+* result is reproducible after `seed_random()` regardless of scheduling.
+* @param N The size of the population
+* @param n The sample size
+* @param out A buffer with room for at least `n` indices.
+* @param threads The number of ranges and worker threads. `0` uses the
+* number of hardware threads.
+* @return The number of indices written, which is always `n`.
+*/
+uint64_t parallel_sample(uint64_t N, uint64_t n, uint64_t * out,
+                         uint32_t threads = 0);
+
+} // Namespace BS
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "describe.h"
+#include "histogram.h"
+
+namespace BS {
+
+namespace detail {
+
+// Run work(t) for t in [0, threads) with t = 0 on the calling thread, and
+// rethrow the first exception in thread order
+template <typename F>
+void parallel_for(uint32_t threads, F work)
+{
+  std::vector<std::exception_ptr> errors(threads);
+  auto guarded = [&](uint32_t t)
+  {
+    try
+    {
+      work(t);
+    }
+    catch (...)
+    {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (uint32_t t = 1; t < threads; t++)
+    pool.emplace_back(guarded, t);
+  guarded(0);
+  for (auto& th : pool)
+    th.join();
+  for (auto& e : errors)
+  {
+    if (e)
+      std::rethrow_exception(e);
+  }
+}
+
+inline uint32_t parallel_threads(uint32_t threads, uint64_t n)
+{
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (threads > n)
+    threads = static_cast<uint32_t>(std::max<uint64_t>(1, n));
+  return threads;
+}
+
+inline uint64_t parallel_lo(uint64_t n, uint32_t threads, uint32_t t)
+{
+  return n / threads * t + std::min<uint64_t>(t, n % threads);
+}
+
+} // namespace detail
+
+/**
+* @brief Compute descriptive statistics over an array using several threads.
+*
+* The array is split into `threads` contiguous ranges, each of which is added
+* to its own `desc_stats` on a worker thread (and sorted there in
+* `stats_mode::full`). The parts are then combined with
+* `desc_stats::merge()`, which only needs a k-way merge of the sorted runs.
+* Exceptions on the worker threads are rethrown to the caller.
+* @param data A pointer to the data.
+* @param n The number of values in `data`.
+* @param threads The number of ranges and worker threads. `0` uses the
+* number of hardware threads.
+* @param mode The storage mode of the result, see
+* `desc_stats::default_mode()`.
+* @param compression The accuracy of the quantile sketch in
+* `stats_mode::sketch`.
+* @return The statistics of the whole array.
+*/
+template <typename T>
+desc_stats<T> parallel_desc_stats(const T * data, uint64_t n,
+                                  uint32_t threads = 0,
+                                  stats_mode mode =
+                                    desc_stats<T>::default_mode(),
+                                  double compression = 200)
+{
+  threads = detail::parallel_threads(threads, n);
+  std::vector<desc_stats<T>> parts(threads, desc_stats<T>(mode, compression));
+  detail::parallel_for(threads, [&](uint32_t t)
+  {
+    uint64_t lo = detail::parallel_lo(n, threads, t);
+    uint64_t hi = detail::parallel_lo(n, threads, t + 1);
+    for (uint64_t i = lo; i < hi; i++)
+      parts[t].add(data[i]);
+    if (mode == stats_mode::full && hi > lo)
+      parts[t].sort();
+  });
+  return desc_stats<T>::merge(parts);
+}
+
+/**
+* @brief Build a histogram with known bounds over an array using several
+* threads.
+*
+* The array is split into `threads` contiguous ranges, each of which is
+* binned with the bulk `histogram::add()` into a private histogram on a worker
+* thread. The private counts are then summed, so the result is the same as
+* `histogram(data, min, max, bins)` for any number of threads.
+* @param data A pointer to the data.
+* @param n The number of values in `data`.
+* @param min The lower bound of the histogram data.
+* @param max The upper bound of the histogram data.
+* @param bins The number of bins.
+* @param threads The number of ranges and worker threads. `0` uses the
+* number of hardware threads.
+* @return The histogram of the whole array.
+*/
+template <typename T>
+histogram<T> parallel_histogram(const T * data, uint64_t n, T min, T max,
+                                uint32_t bins, uint32_t threads = 0)
+{
+  threads = detail::parallel_threads(threads, n);
+  histogram<T> h(min, max, bins);
+  std::vector<histogram<T>> parts(threads, h);
+  detail::parallel_for(threads, [&](uint32_t t)
+  {
+    parts[t].add(data + detail::parallel_lo(n, threads, t),
+                 data + detail::parallel_lo(n, threads, t + 1));
+  });
+  for (const auto& part : parts)
+    h += part;
+  return h;
+}
+
+/**
+* @brief Build a histogram over an array using several threads, with the
+* bounds taken from the data.
+*
+* The min and max are reduced per range on the worker threads and combined in
+* range order, which gives the same bounds as a serial scan, then the data is
+* binned as with the overload with known bounds. The result is the same as
+* `histogram(data, bins)` for any number of threads.
+* @param data A pointer to the data.
+* @param n The number of values in `data`.
+* @param bins The number of bins.
+* @param threads The number of ranges and worker threads. `0` uses the
+* number of hardware threads.
+* @return The histogram of the whole array.
+*/
+template <typename T>
+histogram<T> parallel_histogram(const T * data, uint64_t n, uint32_t bins,
+                                uint32_t threads = 0)
+{
+  if (n == 0)
+    throw std::runtime_error("[BS::parallel_histogram] data is empty");
+  threads = detail::parallel_threads(threads, n);
+  std::vector<T> mins(threads);
+  std::vector<T> maxs(threads);
+  detail::parallel_for(threads, [&](uint32_t t)
+  {
+    const T * begin = data + detail::parallel_lo(n, threads, t);
+    const T * end = data + detail::parallel_lo(n, threads, t + 1);
+    T lo = *begin;
+    T hi = *begin;
+    for (const T * x = begin; x < end; x++)
+    {
+      if (*x < lo) lo = *x;
+      if (*x > hi) hi = *x;
+    }
+    mins[t] = lo;
+    maxs[t] = hi;
+  });
+  T min = mins[0];
+  T max = maxs[0];
+  for (uint32_t t = 1; t < threads; t++)
+  {
+    if (mins[t] < min) min = mins[t];
+    if (maxs[t] > max) max = maxs[t];
+  }
+  return parallel_histogram(data, n, min, max, bins, threads);
+}
+
+} // Namespace BS
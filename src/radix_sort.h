@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Below this many values per thread, extra threads do not pay for themselves
+#define RADIX_SORT_MIN_N_PER_THREAD (1ULL << 16)
+
+namespace BS {
+
+namespace detail {
+
+template <std::size_t S> struct radix_uint;
+template <> struct radix_uint<1> { typedef uint8_t type; };
+template <> struct radix_uint<2> { typedef uint16_t type; };
+template <> struct radix_uint<4> { typedef uint32_t type; };
+template <> struct radix_uint<8> { typedef uint64_t type; };
+
+/**
+* @brief Map values to unsigned keys with the same order.
+*
+* Unsigned integers are their own keys, signed integers get their sign bit
+* flipped. IEEE-754 values get their sign bit flipped when positive and all
+* bits flipped when negative, so negative values sort in reverse magnitude.
+*/
+template <typename T>
+struct radix_key
+{
+  typedef typename radix_uint<sizeof(T)>::type key_type;
+  static const key_type sign = static_cast<key_type>(1) << (8 * sizeof(T) - 1);
+  static inline key_type get(T x)
+  {
+    key_type k;
+    std::memcpy(&k, &x, sizeof(T));
+    return transform(k, std::integral_constant<int,
+      std::is_floating_point<T>::value ? 2 : std::is_signed<T>::value ? 1 : 0>());
+  }
+  static inline key_type transform(key_type k, std::integral_constant<int, 0>)
+  {
+    return k;
+  }
+  static inline key_type transform(key_type k, std::integral_constant<int, 1>)
+  {
+    return k ^ sign;
+  }
+  static inline key_type transform(key_type k, std::integral_constant<int, 2>)
+  {
+    return (k & sign) ? static_cast<key_type>(~k) :
+                        static_cast<key_type>(k | sign);
+  }
+};
+
+template <typename T>
+void radix_sort(T * data, uint64_t n, uint32_t threads)
+{
+  typedef radix_key<T> key;
+  const uint32_t radix = 256;
+  std::vector<T> buffer(n);
+  T * src = data;
+  T * dst = buffer.data();
+  // counts[t * radix + b]: values of chunk t with digit b
+  std::vector<uint64_t> counts(static_cast<uint64_t>(threads) * radix);
+  auto chunk_lo = [&](uint32_t t)
+  {
+    return n / threads * t + std::min<uint64_t>(t, n % threads);
+  };
+  auto count = [&](uint32_t t, uint32_t shift)
+  {
+    uint64_t * c = counts.data() + static_cast<uint64_t>(t) * radix;
+    std::fill(c, c + radix, 0);
+    uint64_t hi = chunk_lo(t + 1);
+    for (uint64_t i = chunk_lo(t); i < hi; i++)
+      ++c[(key::get(src[i]) >> shift) & (radix - 1)];
+  };
+  auto scatter = [&](uint32_t t, uint32_t shift)
+  {
+    uint64_t * c = counts.data() + static_cast<uint64_t>(t) * radix;
+    uint64_t hi = chunk_lo(t + 1);
+    for (uint64_t i = chunk_lo(t); i < hi; i++)
+      dst[c[(key::get(src[i]) >> shift) & (radix - 1)]++] = src[i];
+  };
+  auto run = [&](uint32_t shift, bool scatter_pass)
+  {
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (uint32_t t = 1; t < threads; t++)
+    {
+      if (scatter_pass)
+        pool.emplace_back(scatter, t, shift);
+      else
+        pool.emplace_back(count, t, shift);
+    }
+    if (scatter_pass)
+      scatter(0, shift);
+    else
+      count(0, shift);
+    for (auto& th : pool)
+      th.join();
+  };
+  for (uint32_t shift = 0; shift < 8 * sizeof(T); shift += 8)
+  {
+    run(shift, false);
+    // Skip digits which are the same for all values
+    bool trivial = false;
+    for (uint32_t b = 0; b < radix && ! trivial; b++)
+    {
+      uint64_t total = 0;
+      for (uint32_t t = 0; t < threads; t++)
+        total += counts[static_cast<uint64_t>(t) * radix + b];
+      trivial = total == n;
+    }
+    if (trivial)
+      continue;
+    // Turn counts into write offsets, in digit then chunk order so the
+    // scatter is stable
+    uint64_t offset = 0;
+    for (uint32_t b = 0; b < radix; b++)
+    {
+      for (uint32_t t = 0; t < threads; t++)
+      {
+        uint64_t& c = counts[static_cast<uint64_t>(t) * radix + b];
+        uint64_t tmp = c;
+        c = offset;
+        offset += tmp;
+      }
+    }
+    run(shift, true);
+    std::swap(src, dst);
+  }
+  if (src != data)
+    std::copy(src, src + n, data);
+}
+
+} // namespace detail
+
+/**
+* @brief Check if a type can be sorted by `radix_sort()`.
+*
+* Integers (but not `bool`), `float` and `double` qualify.
+*/
+template <typename T>
+struct is_radix_sortable : std::integral_constant<bool,
+  (std::is_integral<T>::value && ! std::is_same<T, bool>::value) ||
+  (std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 &&
+   (sizeof(T) == 4 || sizeof(T) == 8))> {};
+
+/**
+* @brief Sort numbers in ascending order with a parallel LSD radix sort.
+*
+* Values are mapped to unsigned keys with the same order and sorted one byte
+* at a time, with passes over digits that are equal for all values skipped.
+* Each pass counts digits per chunk on worker threads and then scatters every
+* chunk to precomputed offsets, so the sort is stable and the result does not
+* depend on the number of threads. Needs a buffer of `n` values.
+*
+* Floating point values are ordered by their bits: `-0.0` sorts before `0.0`,
+* and NaNs sort before `-inf` or after `inf` depending on their sign.
+* @param data A pointer to the data.
+* @param n The number of values in `data`.
+* @param threads The number of worker threads. `0` uses the number of hardware
+* threads, capped so that each thread gets at least
+* `RADIX_SORT_MIN_N_PER_THREAD` values.
+*/
+template <typename T>
+void radix_sort(T * data, uint64_t n, uint32_t threads = 0)
+{
+  static_assert(is_radix_sortable<T>::value,
+                "radix_sort needs integers, float or double");
+  if (n < 2)
+    return;
+  if (threads == 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<uint32_t>(std::max<uint64_t>(1,
+      std::min<uint64_t>(threads, n / RADIX_SORT_MIN_N_PER_THREAD)));
+  }
+  if (threads > n)
+    threads = static_cast<uint32_t>(n);
+  detail::radix_sort(data, n, threads);
+}
+
+} // namespace BS
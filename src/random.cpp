@@ -0,0 +1,86 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include "random.h"
+
+namespace BS {
+
+namespace {
+
+std::mutex seed_mutex;
+bool seeded = false;
+uint64_t base_seed = 0;
+uint64_t thread_counter = 0;
+// Bumped on every seed_random() so threads know to re-initialise
+std::atomic<uint64_t> generation(0);
+
+struct thread_state
+{
+  thread_state() : generation(std::numeric_limits<uint64_t>::max()) {}
+  uint64_t generation;
+  default_engine engine;
+};
+
+thread_local thread_state local_state;
+
+void init_thread_state(thread_state& state)
+{
+  std::lock_guard<std::mutex> lock(seed_mutex);
+  if (! seeded)
+  {
+    std::random_device rd;
+    base_seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    seeded = true;
+  }
+  state.engine = default_engine(base_seed);
+  for (uint64_t i = 0; i < thread_counter; i++)
+  {
+    state.engine.long_jump();
+  }
+  ++thread_counter;
+  state.generation = generation.load();
+}
+
+} // namespace
+
+void seed_random(uint64_t seed)
+{
+  {
+    std::lock_guard<std::mutex> lock(seed_mutex);
+    base_seed = seed;
+    seeded = true;
+    thread_counter = 0;
+    ++generation;
+  }
+  init_thread_state(local_state);
+}
+
+default_engine& thread_engine()
+{
+  if (local_state.generation != generation.load(std::memory_order_relaxed))
+  {
+    init_thread_state(local_state);
+  }
+  return local_state.engine;
+}
+
+default_engine split_engine()
+{
+  default_engine& engine = thread_engine();
+  default_engine ret = engine;
+  engine.jump();
+  return ret;
+}
+
+default_engine stream_engine(uint64_t seed, uint64_t stream)
+{
+  default_engine engine(seed);
+  for (uint64_t i = 0; i < stream; i++)
+  {
+    engine.jump();
+  }
+  return engine;
+}
+
+} // Namespace BS
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include "aux.h"
+
+namespace BS {
+
+/**
+* @brief SplitMix64 generator.
+*
+* A tiny 64 bit generator which is mainly used to expand a single seed into
+* the state of the larger engines below.
+*/
+class splitmix64 {
+public:
+  typedef uint64_t result_type;
+  /**
+  * @brief Constructor from a seed.
+  * @param seed The initial state.
+  */
+  explicit splitmix64(uint64_t seed = 0) : _state(seed) {}
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max()
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+  /**
+  * @brief Generate the next 64 random bits.
+  */
+  inline result_type operator()()
+  {
+    uint64_t z = (_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+private:
+  uint64_t _state;
+};
+
+/**
+* @brief The xoshiro256** generator by Blackman and Vigna.
+*
+* A fast, small state 64 bit engine which satisfies the standard
+* UniformRandomBitGenerator requirements. This is the default engine of the
+* samplers.
+* @cite Blackman2021
+*/
+class xoshiro256ss {
+public:
+  typedef uint64_t result_type;
+  /**
+  * @brief Constructor from a seed.
+  *
+  * The seed is expanded into the 256 bit state using `splitmix64`.
+  * @param seed The seed.
+  */
+  explicit xoshiro256ss(uint64_t seed = 0x853c49e6748fea9bULL)
+  {
+    this->seed(seed);
+  }
+  /**
+  * @brief Reset the state from a seed.
+  * @param seed The seed.
+  */
+  inline void seed(uint64_t seed)
+  {
+    splitmix64 sm(seed);
+    for (auto& s : _s)
+      s = sm();
+  }
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max()
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+  /**
+  * @brief Generate the next 64 random bits.
+  */
+  inline result_type operator()()
+  {
+    const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+    const uint64_t t = _s[1] << 17;
+    _s[2] ^= _s[0];
+    _s[3] ^= _s[1];
+    _s[1] ^= _s[2];
+    _s[0] ^= _s[3];
+    _s[2] ^= t;
+    _s[3] = rotl(_s[3], 45);
+    return result;
+  }
+  /**
+  * @brief Advance the state by 2^128 steps.
+  *
+  * Calling `jump()` repeatedly yields up to 2^128 non-overlapping
+  * subsequences.
+  */
+  inline void jump()
+  {
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    apply_jump(JUMP);
+  }
+  /**
+  * @brief Advance the state by 2^192 steps.
+  *
+  * Calling `long_jump()` repeatedly yields up to 2^64 starting points, each of
+  * which can be further split with `jump()`.
+  */
+  inline void long_jump()
+  {
+    static const uint64_t LONG_JUMP[] = {0x76e15d3efefdcbbfULL,
+                                         0xc5004e441c522fb3ULL,
+                                         0x77710069854ee241ULL,
+                                         0x39109bb02acbe635ULL};
+    apply_jump(LONG_JUMP);
+  }
+private:
+  inline void apply_jump(const uint64_t * poly)
+  {
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++)
+    {
+      for (int b = 0; b < 64; b++)
+      {
+        if (poly[i] & (1ULL << b))
+        {
+          s[0] ^= _s[0];
+          s[1] ^= _s[1];
+          s[2] ^= _s[2];
+          s[3] ^= _s[3];
+        }
+        (*this)();
+      }
+    }
+    std::memcpy(_s, s, sizeof(_s));
+  }
+  static inline uint64_t rotl(const uint64_t x, int k)
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+  uint64_t _s[4];
+};
+
+/**
+* @brief The PCG32 (XSH RR) generator by O'Neill.
+*
+* A 32 bit output engine with 64 bit state and selectable stream. Useful when
+* engine state size matters more than raw speed.
+* @cite ONeill2014
+*/
+class pcg32 {
+public:
+  typedef uint32_t result_type;
+  /**
+  * @brief Constructor from a seed and stream.
+  * @param seed The seed.
+  * @param stream The stream selector. Different streams give independent
+  * sequences for the same seed.
+  */
+  explicit pcg32(uint64_t seed = 0x853c49e6748fea9bULL,
+                 uint64_t stream = 0xda3e39cb94b95bdbULL)
+  {
+    this->seed(seed, stream);
+  }
+  /**
+  * @brief Reset the state from a seed and stream.
+  * @param seed The seed.
+  * @param stream The stream selector.
+  */
+  inline void seed(uint64_t seed, uint64_t stream = 0xda3e39cb94b95bdbULL)
+  {
+    _state = 0;
+    _inc = (stream << 1) | 1;
+    (*this)();
+    _state += seed;
+    (*this)();
+  }
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max()
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+  /**
+  * @brief Generate the next 32 random bits.
+  */
+  inline result_type operator()()
+  {
+    uint64_t old = _state;
+    _state = old * 6364136223846793005ULL + _inc;
+    uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    uint32_t rot = static_cast<uint32_t>(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+  }
+private:
+  uint64_t _state;
+  uint64_t _inc;
+};
+
+/**
+* @brief The default engine used by the samplers.
+*/
+typedef xoshiro256ss default_engine;
+
+namespace detail {
+
+template <typename URBG>
+inline uint64_t random_bits64(URBG& g, std::true_type /* 64 bit output */)
+{
+  return static_cast<uint64_t>(g());
+}
+
+template <typename URBG>
+inline uint64_t random_bits64(URBG& g, std::false_type /* 32 bit output */)
+{
+  uint64_t hi = static_cast<uint64_t>(g());
+  return (hi << 32) | static_cast<uint64_t>(g());
+}
+
+template <typename URBG>
+struct full_range
+{
+  typedef typename URBG::result_type result_type;
+  static constexpr bool bits64 =
+    URBG::min() == 0 && URBG::max() == std::numeric_limits<uint64_t>::max();
+  static constexpr bool bits32 =
+    URBG::min() == 0 && URBG::max() == std::numeric_limits<uint32_t>::max();
+};
+
+template <typename URBG>
+inline double uniform_open_unit(URBG& g, std::true_type /* full range */)
+{
+  // Place the top 52 random bits into the mantissa of a double in [1, 2)
+  uint64_t bits = random_bits64(
+    g, std::integral_constant<bool, full_range<URBG>::bits64>());
+  bits = (bits >> 12) | 0x3ff0000000000000ULL;
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  // d - 1 lies in [0, UB()], only its lowest value needs lifting
+  d -= 1.0;
+  return d < LB() ? LB() : d;
+}
+
+template <typename URBG>
+inline double uniform_open_unit(URBG& g, std::false_type /* other ranges */)
+{
+  double d = std::generate_canonical<double,
+                                     std::numeric_limits<double>::digits>(g);
+  return d < LB() ? LB() : (d > UB() ? UB() : d);
+}
+
+} // namespace detail
+
+/**
+* @brief Generate a random double in the open unit interval from an engine.
+*
+* Engines with a full 32 or 64 bit output range use a bit trick which fills
+* the mantissa directly, so no division or distribution object is involved. The
+* result always lies in `[LB(), UB()]`.
+* @param g A UniformRandomBitGenerator.
+* @return A random double in the open unit interval.
+*/
+template <typename URBG>
+inline double uniform_open_unit(URBG& g)
+{
+  return detail::uniform_open_unit(
+    g, std::integral_constant<bool, detail::full_range<URBG>::bits64 ||
+                                    detail::full_range<URBG>::bits32>());
+}
+
+/**
+* @brief Seed the library wide random state.
+*
+* Every thread owns a `default_engine`. Thread engines start from the seed and
+* are separated by `long_jump()`, in the order in which threads first draw.
+* Calling this resets the thread order, re-seeds the calling thread
+* immediately and all other threads on their next draw. Without a call to
+* this function the seed is taken from `std::random_device`.
+* @param seed The seed.
+*/
+void seed_random(uint64_t seed);
+
+/**
+* @brief Get the engine of the calling thread.
+* @return A reference to the thread local engine.
+*/
+default_engine& thread_engine();
+
+/**
+* @brief Split off an independent engine from the calling thread's engine.
+*
+* The returned engine is a copy of the thread engine, which is then advanced
+* with `jump()`, so the two never overlap. All samplers which are not given an
+* explicit engine get theirs from here.
+* @return A new engine.
+*/
+default_engine split_engine();
+
+/**
+* @brief Get an independent, reproducible engine for a numbered stream.
+*
+* Stream `i` is the engine seeded with `seed` and advanced by `i` calls to
+* `jump()`. Use this to give each worker of a parallel job its own sequence
+* which does not depend on thread scheduling.
+* @param seed The seed shared by all streams of a job.
+* @param stream The stream number.
+* @return The engine for the stream.
+*/
+default_engine stream_engine(uint64_t seed, uint64_t stream);
+
+/**
+* @brief Create an engine from the library random state.
+*
+* For the default engine this is `split_engine()`. Other engines are seeded
+* with the next value of the thread engine.
+* @return A new engine.
+*/
+template <typename URBG>
+inline URBG make_seeded_engine()
+{
+  return URBG(thread_engine()());
+}
+
+template <>
+inline default_engine make_seeded_engine<default_engine>()
+{
+  return split_engine();
+}
+
+} // Namespace BS
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <stdexcept>
+#include "reduce.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BS_REDUCE_X86
+#endif
+
+namespace BS {
+
+namespace {
+
+struct kahan
+{
+  kahan() : s(0), c(0) {}
+  inline void add(double v)
+  {
+    double y = v - c;
+    double t = s + y;
+    c = (t - s) - y;
+    s = t;
+  }
+  double s;
+  double c;
+};
+
+struct accumulator
+{
+  accumulator(double first) : min(first), max(first) {}
+  inline void add(double x, double shift)
+  {
+    if (x < min) min = x;
+    if (x > max) max = x;
+    double d = x - shift;
+    double p = d;
+    for (int j = 0; j < 4; j++)
+    {
+      sums[j].add(p);
+      p *= d;
+    }
+  }
+  // Fold in a lane with sum s and compensation c, whose value is s - c
+  inline void add_lane(int j, double s, double c)
+  {
+    sums[j].add(s);
+    sums[j].add(-c);
+  }
+  kahan sums[4];
+  double min;
+  double max;
+};
+
+void reduce_scalar(const double * x, uint64_t n, double shift,
+                   accumulator& acc)
+{
+  for (uint64_t i = 0; i < n; i++)
+    acc.add(x[i], shift);
+}
+
+#ifdef BS_REDUCE_X86
+
+__attribute__((target("sse2")))
+void reduce_sse2(const double * x, uint64_t n, double shift,
+                 accumulator& acc)
+{
+  __m128d k = _mm_set1_pd(shift);
+  __m128d s[4];
+  __m128d c[4];
+  for (int j = 0; j < 4; j++)
+  {
+    s[j] = _mm_setzero_pd();
+    c[j] = _mm_setzero_pd();
+  }
+  __m128d mn = _mm_set1_pd(acc.min);
+  __m128d mx = _mm_set1_pd(acc.max);
+  uint64_t i = 0;
+  for (; i + 2 <= n; i += 2)
+  {
+    __m128d v = _mm_loadu_pd(x + i);
+    mn = _mm_min_pd(mn, v);
+    mx = _mm_max_pd(mx, v);
+    __m128d d = _mm_sub_pd(v, k);
+    __m128d p = d;
+    for (int j = 0; j < 4; j++)
+    {
+      __m128d y = _mm_sub_pd(p, c[j]);
+      __m128d t = _mm_add_pd(s[j], y);
+      c[j] = _mm_sub_pd(_mm_sub_pd(t, s[j]), y);
+      s[j] = t;
+      p = _mm_mul_pd(p, d);
+    }
+  }
+  double ls[2];
+  double lc[2];
+  for (int j = 0; j < 4; j++)
+  {
+    _mm_storeu_pd(ls, s[j]);
+    _mm_storeu_pd(lc, c[j]);
+    for (int l = 0; l < 2; l++)
+      acc.add_lane(j, ls[l], lc[l]);
+  }
+  _mm_storeu_pd(ls, mn);
+  _mm_storeu_pd(lc, mx);
+  for (int l = 0; l < 2; l++)
+  {
+    acc.min = std::min(acc.min, ls[l]);
+    acc.max = std::max(acc.max, lc[l]);
+  }
+  reduce_scalar(x + i, n - i, shift, acc);
+}
+
+__attribute__((target("avx2")))
+void reduce_avx2(const double * x, uint64_t n, double shift,
+                 accumulator& acc)
+{
+  __m256d k = _mm256_set1_pd(shift);
+  __m256d s[4];
+  __m256d c[4];
+  for (int j = 0; j < 4; j++)
+  {
+    s[j] = _mm256_setzero_pd();
+    c[j] = _mm256_setzero_pd();
+  }
+  __m256d mn = _mm256_set1_pd(acc.min);
+  __m256d mx = _mm256_set1_pd(acc.max);
+  uint64_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256d v = _mm256_loadu_pd(x + i);
+    mn = _mm256_min_pd(mn, v);
+    mx = _mm256_max_pd(mx, v);
+    __m256d d = _mm256_sub_pd(v, k);
+    __m256d p = d;
+    for (int j = 0; j < 4; j++)
+    {
+      __m256d y = _mm256_sub_pd(p, c[j]);
+      __m256d t = _mm256_add_pd(s[j], y);
+      c[j] = _mm256_sub_pd(_mm256_sub_pd(t, s[j]), y);
+      s[j] = t;
+      p = _mm256_mul_pd(p, d);
+    }
+  }
+  double ls[4];
+  double lc[4];
+  for (int j = 0; j < 4; j++)
+  {
+    _mm256_storeu_pd(ls, s[j]);
+    _mm256_storeu_pd(lc, c[j]);
+    for (int l = 0; l < 4; l++)
+      acc.add_lane(j, ls[l], lc[l]);
+  }
+  _mm256_storeu_pd(ls, mn);
+  _mm256_storeu_pd(lc, mx);
+  for (int l = 0; l < 4; l++)
+  {
+    acc.min = std::min(acc.min, ls[l]);
+    acc.max = std::max(acc.max, lc[l]);
+  }
+  reduce_scalar(x + i, n - i, shift, acc);
+}
+
+#endif
+
+bool supported(simd_level level)
+{
+  switch (level)
+  {
+    case simd_level::scalar:
+      return true;
+#ifdef BS_REDUCE_X86
+    case simd_level::sse2:
+      return __builtin_cpu_supports("sse2");
+    case simd_level::avx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+double reduce_result::sum() const
+{
+  return static_cast<double>(count) * shift + sums[0];
+}
+
+double reduce_result::mean() const
+{
+  return shift + sums[0] / static_cast<double>(count);
+}
+
+double reduce_result::central(int p) const
+{
+  // Binomial expansion of sum((d - m)^p) with d = x - shift, m = mean(d)
+  double n = static_cast<double>(count);
+  double m = sums[0] / n;
+  switch (p)
+  {
+    case 2:
+      return sums[1] - m * sums[0];
+    case 3:
+      return sums[2] - 3 * m * sums[1] + 2 * m * m * sums[0];
+    case 4:
+      return sums[3] - 4 * m * sums[2] + 6 * m * m * sums[1] -
+             3 * m * m * m * sums[0];
+    default:
+      throw std::runtime_error("[BS::reduce_result::central] Power must be "
+                               "2, 3 or 4");
+  }
+}
+
+double reduce_result::variance() const
+{
+  return central(2) / static_cast<double>(count - 1);
+}
+
+simd_level best_simd_level()
+{
+  static const simd_level best = supported(simd_level::avx2) ?
+    simd_level::avx2 : supported(simd_level::sse2) ? simd_level::sse2 :
+    simd_level::scalar;
+  return best;
+}
+
+reduce_result reduce(const double * data, uint64_t n)
+{
+  return reduce(data, n, best_simd_level());
+}
+
+reduce_result reduce(const double * data, uint64_t n, simd_level level)
+{
+  if (n == 0)
+  {
+    throw std::runtime_error("[BS::reduce] No data");
+  }
+  if (! supported(level))
+  {
+    throw std::runtime_error("[BS::reduce] Instruction set not supported");
+  }
+  // Shift by the mean of the first values, a cheap estimate of the mean
+  uint64_t head = std::min<uint64_t>(n, 32);
+  double shift = 0;
+  for (uint64_t i = 0; i < head; i++)
+    shift += data[i];
+  shift /= static_cast<double>(head);
+  accumulator acc(data[0]);
+  switch (level)
+  {
+#ifdef BS_REDUCE_X86
+    case simd_level::avx2:
+      reduce_avx2(data, n, shift, acc);
+      break;
+    case simd_level::sse2:
+      reduce_sse2(data, n, shift, acc);
+      break;
+#endif
+    default:
+      reduce_scalar(data, n, shift, acc);
+      break;
+  }
+  reduce_result ret;
+  ret.count = n;
+  ret.shift = shift;
+  for (int j = 0; j < 4; j++)
+    ret.sums[j] = acc.sums[j].s - acc.sums[j].c;
+  ret.min = acc.min;
+  ret.max = acc.max;
+  return ret;
+}
+
+} // namespace BS
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+namespace BS {
+
+/**
+* @brief Instruction sets for the vectorized kernels.
+*/
+enum class simd_level
+{
+  /** Plain C++. */
+  scalar,
+  /** 2 doubles per instruction, always available on x86-64. */
+  sse2,
+  /** 4 doubles per instruction. */
+  avx2
+};
+
+/**
+* @brief Result of `reduce()`: count, extremes and power sums about a shift.
+*
+* The power sums are of `x - shift`, where the shift is an estimate of the
+* mean, which avoids the cancellation of textbook sums of squares.
+*/
+struct reduce_result
+{
+  uint64_t count;
+  double shift;
+  /** Compensated sums of (x - shift)^p for p = 1..4. */
+  double sums[4];
+  double min;
+  double max;
+  /**
+  * @brief Retrieve the sum of the data.
+  * @return The sum of the data.
+  */
+  double sum() const;
+  /**
+  * @brief Retrieve the mean of the data.
+  * @return The mean of the data.
+  */
+  double mean() const;
+  /**
+  * @brief Retrieve a sum of powers of deviations from the mean.
+  * @param p The power, 2, 3 or 4.
+  * @return The sum of (x - mean)^p.
+  */
+  double central(int p) const;
+  /**
+  * @brief Retrieve the sample variance (with n - 1 in the denominator).
+  * @return The variance of the data.
+  */
+  double variance() const;
+};
+
+/**
+* @brief Compute count, sum, sums of powers, min and max in one pass.
+*
+* Every lane keeps Kahan-compensated sums, and the lanes are combined with
+* compensation too, so the sums are accurate to a few ulps independently of
+* the number of values. The kernel is chosen at run time from the
+* instruction sets supported by the CPU, see `best_simd_level()`.
+* @param data A pointer to the data.
+* @param n The number of values in `data`, must not be 0.
+* @return The sums and extremes.
+* @cite Kahan1965
+*/
+reduce_result reduce(const double * data, uint64_t n);
+
+/**
+* @brief Same as `reduce(const double *, uint64_t)` with a fixed kernel.
+*
+* Throws if the CPU does not support `level`.
+* @param data A pointer to the data.
+* @param n The number of values in `data`, must not be 0.
+* @param level The kernel to use.
+* @return The sums and extremes.
+*/
+reduce_result reduce(const double * data, uint64_t n, simd_level level);
+
+/**
+* @brief Retrieve the widest kernel supported by the CPU.
+* @return The kernel used by `reduce(const double *, uint64_t)`.
+*/
+simd_level best_simd_level();
+
+} // namespace BS
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "random.h"
+
+namespace BS {
+
+/**
+* @brief Reservoir sampling of a stream of unknown length.
+*
+* This class implements algorithm L from Li (1994): "Reservoir-sampling
+* algorithms of time complexity O(n(1 + log(N/n)))". Instead of drawing a
+* random number for every record it draws the number of records to skip until
+* the next replacement, so the RNG is consulted O(k log(N/k)) times.
+*
+* Readers can query `skip()` and bypass that many records with `discard()`
+* without parsing them.
+* @cite Li1994
+*/
+template <typename T, typename URBG = default_engine>
+class reservoir_sample {
+public:
+  /**
+  * @brief Basic constructor.
+  *
+  * The engine is taken from the library random state, see `seed_random()`.
+  * @param k The reservoir size.
+  */
+  reservoir_sample(uint64_t k);
+  /**
+  * @brief Constructor with an explicit engine.
+  * @param k The reservoir size.
+  * @param rng The random engine to draw from. It is copied.
+  */
+  reservoir_sample(uint64_t k, const URBG& rng);
+  /**
+  * @brief Offer the next record of the stream.
+  * @param x The record.
+  * @return `true` if the record was placed in the reservoir, `false`
+  * otherwise.
+  */
+  inline bool add(const T& x);
+  /**
+  * @brief Get the number of upcoming records which will not be kept.
+  *
+  * While the reservoir is filling, and when the next record will be kept,
+  * this is `0`.
+  * @return The number of records which can be bypassed with `discard()`.
+  */
+  inline uint64_t skip() const { return _skip; }
+  /**
+  * @brief Bypass records without offering them.
+  * @param m The number of records to bypass, at most `skip()`.
+  */
+  inline void discard(uint64_t m);
+  /**
+  * @brief Get a reference to the reservoir.
+  *
+  * The reservoir is in no particular order.
+  * @return A const vector of the sampled records.
+  */
+  inline const std::vector<T>& const_sample() const { return _reservoir; }
+  /**
+  * @brief Get a copy of the reservoir.
+  * @return A vector of the sampled records.
+  */
+  inline std::vector<T> sample() const { return _reservoir; }
+  /**
+  * @brief Get the number of records currently held.
+  * @return The number of records in the reservoir.
+  */
+  inline uint64_t size() const { return _reservoir.size(); }
+  /**
+  * @brief Get the reservoir size.
+  * @return The maximum number of records held.
+  */
+  inline uint64_t capacity() const { return _k; }
+  /**
+  * @brief Get the number of records seen so far, including discarded ones.
+  * @return The stream length so far.
+  */
+  inline uint64_t seen() const { return _seen; }
+private:
+  void _gen_skip();
+  //
+  std::vector<T> _reservoir;
+  uint64_t _k;
+  uint64_t _seen;
+  uint64_t _skip;
+  double _W;
+  URBG _rng;
+};
+
+template <typename T, typename URBG>
+reservoir_sample<T, URBG>::reservoir_sample(uint64_t k) :
+  reservoir_sample(k, make_seeded_engine<URBG>()) {}
+
+template <typename T, typename URBG>
+reservoir_sample<T, URBG>::reservoir_sample(uint64_t k, const URBG& rng) :
+  _k(k), _seen(0), _skip(0), _W(0), _rng(rng)
+{
+  if (k == 0)
+    throw std::runtime_error("[BS::reservoir_sample::reservoir_sample] "
+                             "Reservoir size must be > 0");
+  _reservoir.reserve(k);
+}
+
+template <typename T, typename URBG>
+void reservoir_sample<T, URBG>::_gen_skip()
+{
+  double s = std::floor(std::log(uniform_open_unit(_rng)) / std::log1p(-_W));
+  _skip = s < static_cast<double>(std::numeric_limits<uint64_t>::max()) ?
+    static_cast<uint64_t>(s) : std::numeric_limits<uint64_t>::max();
+}
+
+template <typename T, typename URBG>
+bool reservoir_sample<T, URBG>::add(const T& x)
+{
+  ++_seen;
+  if (_reservoir.size() < _k)
+  {
+    _reservoir.push_back(x);
+    if (_reservoir.size() == _k)
+    {
+      _W = std::exp(std::log(uniform_open_unit(_rng)) /
+                    static_cast<double>(_k));
+      _gen_skip();
+    }
+    return true;
+  }
+  if (_skip > 0)
+  {
+    --_skip;
+    return false;
+  }
+  uint64_t slot = static_cast<double>(_k) * uniform_open_unit(_rng);
+  _reservoir[slot] = x;
+  _W *= std::exp(std::log(uniform_open_unit(_rng)) / static_cast<double>(_k));
+  _gen_skip();
+  return true;
+}
+
+template <typename T, typename URBG>
+void reservoir_sample<T, URBG>::discard(uint64_t m)
+{
+  if (m > _skip)
+    throw std::runtime_error("[BS::reservoir_sample::discard] Trying to "
+                             "discard " + std::to_string(m) + " records, but "
+                             "only " + std::to_string(_skip) + " can be "
+                             "skipped");
+  _skip -= m;
+  _seen += m;
+}
+
+} // Namespace BS
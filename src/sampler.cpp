@@ -0,0 +1,111 @@
+#include <stdexcept>
+#include "sampler.h"
+
+namespace BS {
+
+sample_method sampler::choose(uint64_t N, uint64_t n, bool replace)
+{
+  if (replace)
+    return n >= SAMPLER_STREAM_MIN_N ? sample_method::replace_stream :
+                                       sample_method::replace_sorted;
+  if (N <= SAMPLER_BITMAP_MAX_N &&
+      static_cast<double>(n) > SAMPLER_BITMAP_FRACTION * static_cast<double>(N))
+    return sample_method::bitmap;
+  return sample_method::vitter_d;
+}
+
+sampler::sampler(uint64_t N, uint64_t n, bool replace) :
+  sampler(N, n, choose(N, n, replace)) {}
+
+sampler::sampler(uint64_t N, uint64_t n, sample_method method) :
+  _method(method), _N(N), _left(n), _complement(false), _word(0),
+  _cur_bits(0)
+{
+  switch (method)
+  {
+    case sample_method::vitter_d:
+      _vd = vitter_d(N, n);
+      break;
+    case sample_method::bitmap:
+      if (n > N)
+        throw std::runtime_error("Cannot sample more than population without "
+                                 "replacement");
+      _init_bitmap();
+      break;
+    case sample_method::replace_sorted:
+      _ss = simple_sample<uint64_t>(N, n, false);
+      break;
+    case sample_method::replace_stream:
+      _ss = simple_sample<uint64_t>(N, n, true);
+      break;
+  }
+}
+
+void sampler::_init_bitmap()
+{
+  // Mark whichever of the sample or its complement is smaller
+  _complement = _left > _N / 2;
+  uint64_t m = _complement ? _N - _left : _left;
+  _bits.assign((_N + 63) / 64, 0);
+  default_engine rng = split_engine();
+  // Floyd's algorithm: m distinct positions with m random draws
+  for (uint64_t j = _N - m; j < _N; j++)
+  {
+    uint64_t t = static_cast<double>(j + 1) * uniform_open_unit(rng);
+    if (_bits[t >> 6] & (1ULL << (t & 63)))
+      t = j;
+    _bits[t >> 6] |= 1ULL << (t & 63);
+  }
+  if (! _bits.empty())
+    _cur_bits = _complement ? ~_bits[0] : _bits[0];
+}
+
+uint64_t sampler::_fill_bitmap(uint64_t * out, uint64_t k)
+{
+  uint64_t written = 0;
+  while (written < k && _left > 0)
+  {
+    while (_cur_bits == 0)
+    {
+      ++_word;
+      _cur_bits = _complement ? ~_bits[_word] : _bits[_word];
+    }
+    // Positions past N in the last word are never reached since exactly n
+    // valid positions come before them
+    out[written++] = (_word << 6) + __builtin_ctzll(_cur_bits);
+    _cur_bits &= _cur_bits - 1;
+    --_left;
+  }
+  return written;
+}
+
+uint64_t sampler::fill(uint64_t * out, uint64_t k)
+{
+  uint64_t written = 0;
+  switch (_method)
+  {
+    case sample_method::vitter_d:
+      written = _vd.fill(out, k);
+      break;
+    case sample_method::bitmap:
+      return _fill_bitmap(out, k);
+    case sample_method::replace_sorted:
+    case sample_method::replace_stream:
+      while (written < k && ! _ss.end())
+        out[written++] = _ss.next();
+      break;
+  }
+  _left -= written;
+  return written;
+}
+
+uint64_t sampler::next()
+{
+  uint64_t ret;
+  if (fill(&ret, 1) == 0)
+    throw std::runtime_error("[BS::sampler::next] Tried to sample past the end "
+                             "of the sample");
+  return ret;
+}
+
+} // Namespace BS
@@ -0,0 +1,119 @@
+#pragma once
+
+// Crossover points, chosen from test_sampler_calibration 10000000 (Release,
+// g++ 12.2, one core of an Intel Xeon). They are heuristic, rerun it to check
+// them on other machines.
+// - Without replacement, bitmap selection took 33 ns per index against 44 ns
+//   for vitter_d at n / N = 0.001, the smallest fraction measured, and won
+//   more clearly above. The fraction is set higher since the bitmap costs
+//   N / 8 bytes.
+// - With replacement, the sorted vector took 42 ns per index against 48 ns
+//   for streaming at n = 64, and 46 ns against 41 ns at n = 256.
+// Without replacement, use bitmap selection once n / N exceeds this fraction
+#define SAMPLER_BITMAP_FRACTION 0.005
+// and only while the bitmap holds no more than this many bits (64 MiB)
+#define SAMPLER_BITMAP_MAX_N (1ULL << 29)
+// With replacement, generate on the fly once n reaches this size
+#define SAMPLER_STREAM_MIN_N 256
+
+#include <cstdint>
+#include <vector>
+#include "random.h"
+#include "simple_sample.h"
+#include "vitter_d.h"
+
+namespace BS {
+
+/**
+* @brief The algorithms available to `sampler`.
+*/
+enum class sample_method
+{
+  /** Vitter's algorithm D, which switches to A by itself when n / N grows. */
+  vitter_d,
+  /** Floyd's algorithm on a bitmap of the population, read out in order. */
+  bitmap,
+  /** With replacement, drawn up front and sorted. */
+  replace_sorted,
+  /** With replacement, generated in order on the fly. */
+  replace_stream
+};
+
+/**
+* @brief Sequential random sampling with an automatically chosen algorithm.
+*
+* The algorithm is picked at construction from the population size, the
+* sample size and whether sampling is with replacement:
+*
+* - Without replacement, `vitter_d` is used unless the sample is a large
+*   fraction of a population small enough for a bitmap. Floyd's algorithm then
+*   marks min(n, N - n) positions in a bitmap which is read out in order,
+*   which avoids one skip computation per sampled index.
+* - With replacement, `simple_sample` is used, in streaming mode for large
+*   samples.
+*
+* All methods yield 0-based indices in increasing order.
+*/
+class sampler {
+public:
+  /**
+  * @brief Basic constructor.
+  * @param N The size of the population
+  * @param n The sample size
+  * @param replace Sample with replacement.
+  */
+  sampler(uint64_t N, uint64_t n, bool replace = false);
+  /**
+  * @brief Constructor with a fixed algorithm.
+  * @param N The size of the population
+  * @param n The sample size
+  * @param method The algorithm to use.
+  */
+  sampler(uint64_t N, uint64_t n, sample_method method);
+  /**
+  * @brief Pick the algorithm for a sampling problem.
+  * @param N The size of the population
+  * @param n The sample size
+  * @param replace Sample with replacement.
+  * @return The algorithm the constructor would choose.
+  */
+  static sample_method choose(uint64_t N, uint64_t n, bool replace);
+  /**
+  * @brief Get next sample.
+  * @return A 0-based index of the next record to sample.
+  */
+  uint64_t next();
+  /**
+  * @brief Get up to `k` next samples in one call.
+  * @param out A buffer with room for at least `k` indices.
+  * @param k The maximum number of indices to write.
+  * @return The number of indices written to `out`.
+  */
+  uint64_t fill(uint64_t * out, uint64_t k);
+  /**
+  * @brief Check if all samples have been retrieved.
+  * @return `true` if all samples have been generated, `false` otherwise
+  */
+  bool end() const { return _left == 0; }
+  /**
+  * @brief Get the algorithm in use.
+  * @return The algorithm.
+  */
+  sample_method method() const { return _method; }
+private:
+  void _init_bitmap();
+  uint64_t _fill_bitmap(uint64_t * out, uint64_t k);
+  //
+  sample_method _method;
+  uint64_t _N;
+  uint64_t _left;
+  vitter_d _vd;
+  simple_sample<uint64_t> _ss;
+  // Bitmap selection
+  std::vector<uint64_t> _bits;
+  bool _complement;
+  uint64_t _word;
+  uint64_t _cur_bits;
+};
+
+} // Namespace BS
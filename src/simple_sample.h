@@ -1,18 +1,27 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <cmath>
 #include <random>
 #include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "random.h"
 
-namespace BS 
+namespace BS
 {
 /**
 * @brief Simple class for oversampling with replacement.
 *
-* Sample generated are stored in a basic sorted vector
+* By default the samples are generated up front and stored in a basic sorted
+* vector. In streaming mode they are generated in order on the fly, in O(1)
+* memory and O(1) time per sample, as the order statistics of `n` uniform
+* variates: given the i-th smallest value `x`, the next one is
+* `1 - (1 - x) * U^(1 / (n - i))`.
 */
 template <typename T>
 class simple_sample {
+  static_assert(std::is_integral<T>::value, "simple_sample needs integers");
 public:
   /**
   * @brief Empty constructor.
@@ -22,8 +31,9 @@ public:
   * @brief Basic constructor.
   * @param N The population size
   * @param n The sample size
+  * @param streaming Generate samples on the fly instead of storing them.
   */
-  simple_sample(T N, T n);
+  simple_sample(T N, T n, bool streaming = false);
   /**
   * @brief Get the next sample
   * @return The next sample (in order)
@@ -33,25 +43,40 @@ public:
   * @brief Check if all data has been sampled
   * @return `true` if all data has beend sampled, `false` otherwise
   */
-  bool end() {return _cur == (_n - 1); }
+  bool end() {return _cur == _n; }
 private:
   std::vector<T> _samp_v;
   T _N;
   T _n;
   T _cur;
+  bool _streaming;
+  // log(1 - x) of the last order statistic x, with its Kahan compensation
+  double _log_rem;
+  double _log_rem_c;
+  default_engine _rng;
 };
 
 template <typename T>
-simple_sample<T>::simple_sample(T N, T n) :
-  _cur(0), _N(N), _n(n)
+simple_sample<T>::simple_sample(T N, T n, bool streaming) :
+  _N(N), _n(n), _cur(0), _streaming(streaming), _log_rem(0), _log_rem_c(0),
+  _rng(split_engine())
 {
+  if (N == 0 && n > 0)
+  {
+    throw std::runtime_error("[BS::simple_sample::simple_sample] Cannot sample "
+                             "from an empty population");
+  }
+  if (streaming)
+  {
+    return;
+  }
   _samp_v.reserve(n);
-  std::random_device rd;
-  std::mt19937 mt(rd());
-  std::uniform_int_distribution<> dis(0, N - 1);
+  // Drawn as uint64_t, since uniform_int_distribution is undefined for
+  // character types
+  std::uniform_int_distribution<uint64_t> dis(0, static_cast<uint64_t>(N) - 1);
   for (T i = 0; i < n; i++)
   {
-    _samp_v.push_back(dis(mt));
+    _samp_v.push_back(static_cast<T>(dis(_rng)));
   }
   std::sort(_samp_v.begin(), _samp_v.end());
 }
@@ -59,7 +84,20 @@ simple_sample<T>::simple_sample(T N, T n) :
 template <typename T>
 T simple_sample<T>::next()
 {
-  return _samp_v[_cur++];
+  if (! _streaming)
+  {
+    return _samp_v[_cur++];
+  }
+  // The minimum of the remaining r uniforms on (x, 1)
+  double r = static_cast<double>(_n - _cur);
+  double y = std::log(uniform_open_unit(_rng)) / r - _log_rem_c;
+  double t = _log_rem + y;
+  _log_rem_c = (t - _log_rem) - y;
+  _log_rem = t;
+  _cur++;
+  double x = - std::expm1(_log_rem);
+  T ret = static_cast<T>(x * static_cast<double>(_N));
+  return ret < _N ? ret : _N - 1;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include "random.h"
+
+// Enough levels for 4^32 values
+#define SKIPLIST_MAX_LEVEL 32
+// Seed of the node heights, fixed so that lists never draw from the library
+// random state
+#define SKIPLIST_SEED 0x5851f42d4c957f2dULL
+
+namespace BS {
+
+/**
+* @brief Sorted multiset with access by rank.
+*
+* This class implements an indexable skip list (Pugh, 1990): every link also
+* stores the number of values it jumps over, so inserting, erasing and finding
+* the value of a given rank all take expected O(log n). Node heights are
+* geometric with p = 1/4, and erased nodes are kept for reuse by later inserts
+* until the list is destroyed.
+* @cite Pugh1990
+*/
+template <typename T>
+class skiplist {
+  struct node;
+  struct link
+  {
+    link() : next(nullptr), width(1) {}
+    node * next;
+    uint64_t width;
+  };
+  // Nodes are allocated with their links in one block of
+  // sizeof(node) + (height - 1) * sizeof(link) bytes
+  struct node
+  {
+    T value;
+    uint32_t height;
+    link links[1];
+  };
+public:
+  /**
+  * @brief Forward iterator over the values in order.
+  */
+  class const_iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T * pointer;
+    typedef const T& reference;
+    const_iterator(const node * n) : _node(n) {}
+    reference operator*() const { return _node->value; }
+    pointer operator->() const { return &_node->value; }
+    const_iterator& operator++()
+    {
+      _node = _node->links[0].next;
+      return *this;
+    }
+    bool operator==(const const_iterator& o) const { return _node == o._node; }
+    bool operator!=(const const_iterator& o) const { return _node != o._node; }
+  private:
+    const node * _node;
+  };
+  /**
+  * @brief Empty constructor
+  *
+  * Node heights come from a `splitmix64` with a fixed seed, so creating a
+  * list leaves the library random state (see `seed_random()`) untouched.
+  */
+  inline skiplist();
+  inline skiplist(const skiplist& other);
+  inline skiplist(skiplist&& other);
+  inline skiplist& operator=(skiplist other);
+  inline ~skiplist();
+  /**
+  * @brief Insert a value, after any equal values.
+  * @param x The value.
+  */
+  inline void insert(const T& x);
+  /**
+  * @brief Erase one occurence of a value.
+  * @param x The value.
+  * @return `true` if a value was erased, `false` if `x` was not found.
+  */
+  inline bool erase(const T& x);
+  /**
+  * @brief Retrieve the value of a given rank.
+  * @param i The 0-based rank, i.e. `at(0)` is the smallest value.
+  * @return The value.
+  */
+  inline const T& at(uint64_t i) const;
+  /**
+  * @brief Retrieve the number of values.
+  * @return The number of values.
+  */
+  inline uint64_t size() const { return _size; }
+  inline bool empty() const { return _size == 0; }
+  /**
+  * @brief Remove all values.
+  */
+  inline void clear();
+  inline const_iterator begin() const
+  {
+    return const_iterator(_head[0].next);
+  }
+  inline const_iterator end() const { return const_iterator(nullptr); }
+private:
+  inline uint32_t _height();
+  inline node * _alloc(const T& x, uint32_t height);
+  inline void _free(node * n);
+  inline void _swap(skiplist& other);
+  //
+  link _head[SKIPLIST_MAX_LEVEL];
+  // Number of levels in use
+  uint32_t _level;
+  uint64_t _size;
+  splitmix64 _rng;
+  // Erased nodes by height, reused by inserts
+  std::vector<node *> _pool[SKIPLIST_MAX_LEVEL];
+};
+
+template <typename T>
+skiplist<T>::skiplist() : _level(1), _size(0),
+  _rng(SKIPLIST_SEED) {}
+
+template <typename T>
+skiplist<T>::skiplist(const skiplist& other) : _level(1), _size(0),
+  _rng(other._rng)
+{
+  for (const T& x : other)
+    insert(x);
+}
+
+template <typename T>
+skiplist<T>::skiplist(skiplist&& other) : _level(1), _size(0),
+  _rng(other._rng)
+{
+  _swap(other);
+}
+
+template <typename T>
+skiplist<T>& skiplist<T>::operator=(skiplist other)
+{
+  _swap(other);
+  return *this;
+}
+
+template <typename T>
+void skiplist<T>::_swap(skiplist& other)
+{
+  for (uint32_t level = 0; level < SKIPLIST_MAX_LEVEL; level++)
+  {
+    std::swap(_head[level], other._head[level]);
+    std::swap(_pool[level], other._pool[level]);
+  }
+  std::swap(_level, other._level);
+  std::swap(_size, other._size);
+  std::swap(_rng, other._rng);
+}
+
+template <typename T>
+skiplist<T>::~skiplist()
+{
+  clear();
+  for (auto& pool : _pool)
+  {
+    for (node * n : pool)
+      ::operator delete(n);
+  }
+}
+
+template <typename T>
+typename skiplist<T>::node * skiplist<T>::_alloc(const T& x, uint32_t height)
+{
+  node * n;
+  if (! _pool[height - 1].empty())
+  {
+    n = _pool[height - 1].back();
+    _pool[height - 1].pop_back();
+  }
+  else
+  {
+    n = static_cast<node *>(::operator new(sizeof(node) +
+                                           (height - 1) * sizeof(link)));
+  }
+  new (&n->value) T(x);
+  n->height = height;
+  return n;
+}
+
+template <typename T>
+void skiplist<T>::_free(node * n)
+{
+  n->value.~T();
+  _pool[n->height - 1].push_back(n);
+}
+
+template <typename T>
+uint32_t skiplist<T>::_height()
+{
+  // Each pair of trailing zero bits adds a level
+  uint64_t r = _rng() | (1ULL << (2 * (SKIPLIST_MAX_LEVEL - 1)));
+  return 1 + __builtin_ctzll(r) / 2;
+}
+
+template <typename T>
+void skiplist<T>::insert(const T& x)
+{
+  uint32_t height = _height();
+  if (height > _level)
+  {
+    // Links of new levels span the whole list
+    for (uint32_t level = _level; level < height; level++)
+      _head[level].width = _size + 1;
+    _level = height;
+  }
+  link * chain[SKIPLIST_MAX_LEVEL];
+  uint64_t steps_at[SKIPLIST_MAX_LEVEL];
+  link * cur = _head;
+  uint64_t steps = 0;
+  for (int level = _level - 1; level >= 0; level--)
+  {
+    while (cur[level].next && ! (x < cur[level].next->value))
+    {
+      steps += cur[level].width;
+      cur = cur[level].next->links;
+    }
+    chain[level] = cur + level;
+    steps_at[level] = steps;
+  }
+  node * n = _alloc(x, height);
+  for (uint32_t level = 0; level < height; level++)
+  {
+    link& prev = *chain[level];
+    uint64_t behind = steps - steps_at[level];
+    n->links[level].next = prev.next;
+    n->links[level].width = prev.width - behind;
+    prev.next = n;
+    prev.width = behind + 1;
+  }
+  for (uint32_t level = height; level < _level; level++)
+    chain[level]->width++;
+  _size++;
+}
+
+template <typename T>
+bool skiplist<T>::erase(const T& x)
+{
+  link * chain[SKIPLIST_MAX_LEVEL];
+  link * cur = _head;
+  for (int level = _level - 1; level >= 0; level--)
+  {
+    while (cur[level].next && cur[level].next->value < x)
+      cur = cur[level].next->links;
+    chain[level] = cur + level;
+  }
+  node * n = chain[0]->next;
+  if (! n || x < n->value || n->value < x)
+    return false;
+  for (uint32_t level = 0; level < n->height; level++)
+  {
+    link& prev = *chain[level];
+    prev.width += n->links[level].width - 1;
+    prev.next = n->links[level].next;
+  }
+  for (uint32_t level = n->height; level < _level; level++)
+    chain[level]->width--;
+  _free(n);
+  _size--;
+  return true;
+}
+
+template <typename T>
+const T& skiplist<T>::at(uint64_t i) const
+{
+  if (i >= _size)
+  {
+    throw std::runtime_error("[BS::skiplist::at] Rank out of range");
+  }
+  const link * cur = _head;
+  const node * n = nullptr;
+  i++;
+  for (int level = _level - 1; level >= 0; level--)
+  {
+    while (cur[level].next && cur[level].width <= i)
+    {
+      i -= cur[level].width;
+      n = cur[level].next;
+      cur = n->links;
+    }
+  }
+  return n->value;
+}
+
+template <typename T>
+void skiplist<T>::clear()
+{
+  node * cur = _head[0].next;
+  while (cur)
+  {
+    node * next = cur->links[0].next;
+    _free(cur);
+    cur = next;
+  }
+  for (auto& l : _head)
+    l = link();
+  _level = 1;
+  _size = 0;
+}
+
+} // Namespace BS
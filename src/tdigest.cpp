@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "tdigest.h"
+
+namespace BS {
+
+static const double PI = 3.14159265358979323846;
+
+tdigest::tdigest(double compression) :
+  _compression(compression), _merged(0), _unmerged(0),
+  _min(std::numeric_limits<double>::infinity()),
+  _max(-std::numeric_limits<double>::infinity())
+{
+  if (compression < 10)
+    throw std::runtime_error("[BS::tdigest::tdigest] Compression must be at "
+                             "least 10");
+  _buffer_limit = static_cast<uint64_t>(5 * compression);
+}
+
+void tdigest::_compress()
+{
+  if (_buffer.empty())
+    return;
+  _buffer.insert(_buffer.end(), _centroids.begin(), _centroids.end());
+  std::sort(_buffer.begin(), _buffer.end(),
+            [](const centroid& lhs, const centroid& rhs)
+            {
+              return lhs.mean < rhs.mean;
+            });
+  double total = _merged + _unmerged;
+  double norm = _compression / (2 * PI);
+  _centroids.clear();
+  // Merge neighbours while the span in k-space stays within 1, with the
+  // scale function k(q) = compression / (2 pi) * asin(2q - 1)
+  centroid cur = _buffer[0];
+  double w_so_far = 0;
+  double k_left = norm * std::asin(-1.0);
+  for (uint64_t i = 1; i < _buffer.size(); i++)
+  {
+    const centroid& next = _buffer[i];
+    double q = (w_so_far + cur.weight + next.weight) / total;
+    double k_right = norm * std::asin(2 * std::min(q, 1.0) - 1);
+    if (k_right - k_left <= 1)
+    {
+      cur.weight += next.weight;
+      cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+    }
+    else
+    {
+      _centroids.push_back(cur);
+      w_so_far += cur.weight;
+      k_left = norm * std::asin(2 * std::min(w_so_far / total, 1.0) - 1);
+      cur = next;
+    }
+  }
+  _centroids.push_back(cur);
+  _buffer.clear();
+  _merged = total;
+  _unmerged = 0;
+}
+
+void tdigest::merge(const tdigest& other)
+{
+  for (const auto& c : other._centroids)
+    _buffer.push_back(c);
+  for (const auto& c : other._buffer)
+    _buffer.push_back(c);
+  _unmerged += other._merged + other._unmerged;
+  _min = std::min(_min, other._min);
+  _max = std::max(_max, other._max);
+  _compress();
+}
+
+uint64_t tdigest::centroids()
+{
+  _compress();
+  return _centroids.size();
+}
+
+uint64_t tdigest::memory_bytes() const
+{
+  return sizeof(*this) +
+         (_centroids.capacity() + _buffer.capacity()) * sizeof(centroid);
+}
+
+double tdigest::quantile(double q)
+{
+  if (q < 0 || q > 1)
+  {
+    throw std::runtime_error("[BS::tdigest::quantile]\t Probability must be"
+                             "between 0 and 1");
+  }
+  _compress();
+  if (_centroids.empty())
+  {
+    throw std::runtime_error("[BS::tdigest::quantile] No data");
+  }
+  if (_centroids.size() == 1 && _centroids[0].weight == 1)
+  {
+    return _centroids[0].mean;
+  }
+  // Positions are on the cumulative weight axis, where a single point i sits
+  // at i + 0.5. The min and max points sit at 0.5 and total - 0.5.
+  double total = _merged;
+  double index = q * (total - 1) + 0.5;
+  if (index <= 0.5)
+  {
+    return _min;
+  }
+  if (index >= total - 0.5)
+  {
+    return _max;
+  }
+  double left_pos = 0.5;
+  double left_val = _min;
+  double w_so_far = 0;
+  for (const auto& c : _centroids)
+  {
+    double center = w_so_far + c.weight / 2;
+    if (index < center)
+    {
+      if (center <= left_pos)
+        return c.mean;
+      return left_val + (index - left_pos) / (center - left_pos) *
+                        (c.mean - left_val);
+    }
+    left_pos = center;
+    left_val = c.mean;
+    w_so_far += c.weight;
+  }
+  double right_pos = total - 0.5;
+  if (right_pos <= left_pos)
+    return _max;
+  return left_val + (index - left_pos) / (right_pos - left_pos) *
+                    (_max - left_val);
+}
+
+} // namespace BS
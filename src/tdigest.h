@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace BS {
+
+/**
+* @brief Bounded memory quantile sketch.
+*
+* This class implements the merging t-digest from Dunning (2019): "Computing
+* extremely accurate quantiles using t-digests". Data is summarised as a
+* sorted list of weighted centroids whose size is limited by the `asin` scale
+* function, which keeps centroids small near the tails. Memory is
+* O(compression) regardless of the number of values added, and digests can be
+* merged.
+* @cite Dunning2019
+*/
+class tdigest {
+public:
+  /**
+  * @brief Basic constructor.
+  * @param compression The accuracy parameter. The digest holds at most about
+  * `compression` centroids, larger values are more accurate.
+  */
+  tdigest(double compression = 200);
+  /**
+  * @brief Add a data point.
+  * @param x The data point.
+  * @param w The weight of the data point.
+  */
+  inline void add(double x, double w = 1)
+  {
+    _buffer.push_back(centroid(x, w));
+    if (x < _min) _min = x;
+    if (x > _max) _max = x;
+    _unmerged += w;
+    if (_buffer.size() >= _buffer_limit)
+      _compress();
+  }
+  /**
+  * @brief Merge another digest into this one.
+  * @param other The digest to merge.
+  */
+  void merge(const tdigest& other);
+  /**
+  * @brief Estimate the value at a given quantile.
+  *
+  * When every centroid holds a single point this is the same Hyndman-Fan type
+  * 7 estimate as `desc_stats::quantile()`.
+  * @param q The quantile as a fraction, e.g.: `0.5` for Q50.
+  * @return The estimated value at the given quantile.
+  */
+  double quantile(double q);
+  /**
+  * @brief Estimate the median.
+  * @return The estimated median.
+  */
+  inline double median() { return quantile(0.5); }
+  /**
+  * @brief Retrieve the total weight of the data.
+  * @return The total weight of the data.
+  */
+  inline double count() const { return _merged + _unmerged; }
+  /**
+  * @brief Retrieve the number of centroids after merging the buffer.
+  * @return The number of centroids.
+  */
+  uint64_t centroids();
+  /**
+  * @brief Retrieve the memory held by the digest.
+  * @return The size of the centroid and buffer storage in bytes.
+  */
+  uint64_t memory_bytes() const;
+  /**
+  * @brief Retrieve the accuracy parameter.
+  * @return The compression.
+  */
+  inline double compression() const { return _compression; }
+private:
+  struct centroid
+  {
+    centroid(double m, double w) : mean(m), weight(w) {}
+    double mean;
+    double weight;
+  };
+  void _compress();
+  //
+  double _compression;
+  uint64_t _buffer_limit;
+  std::vector<centroid> _centroids;
+  std::vector<centroid> _buffer;
+  double _merged;
+  double _unmerged;
+  double _min;
+  double _max;
+};
+
+} // namespace BS
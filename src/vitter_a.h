@@ -1,31 +1,47 @@
 #pragma once
 
 #include <cstdint>
+#include <stdexcept>
+#include "aux.h"
+#include "common.h"
+#include "random.h"
 
 namespace BS {
 
+template <typename URBG> class basic_vitter_d;
+
 /**
 * @brief Vitter's  algorithm A for sequential random sampling.
-* 
+*
 * This class implements algorithm A from Vitter (1984): "Faster methods for
-* random sampling".
+* random sampling". The random engine is a template parameter so it can be
+* inlined into the skip loop, see `vitter_a` for the default.
 * @cite Vitter1984
 */
-class vitter_a {
+template <typename URBG>
+class basic_vitter_a {
 public:
   /**
   * @brief Empty constructor.
   */
-  vitter_a(){}
+  basic_vitter_a(){}
   /**
   * @brief Basic constructor.
   *
   * This will instantiate the class for population size N and sample size n. The
-  * sample size n has to be less than the population N.
+  * sample size n has to be less than the population N. The engine is taken
+  * from the library random state, see `seed_random()`.
+  * @param N The size of the population
+  * @param n The sample size
+  */
+  basic_vitter_a(uint64_t N, uint64_t n);
+  /**
+  * @brief Constructor with an explicit engine.
   * @param N The size of the population
   * @param n The sample size
+  * @param rng The random engine to draw from. It is copied.
   */
-  vitter_a(uint64_t N, uint64_t n);
+  basic_vitter_a(uint64_t N, uint64_t n, const URBG& rng);
   /**
   * @brief Get next sample.
   *
@@ -35,23 +51,121 @@ public:
   */
   uint64_t next();
   /**
+  * @brief Get up to `k` next samples in one call.
+  *
+  * This method writes the sequentially next records to sample into `out`,
+  * avoiding the per-call overhead of `next()` when many indices are needed.
+  * The indices are 0 based and in increasing order. Fewer than `k` indices
+  * are written once all samples have been generated.
+  * @param out A buffer with room for at least `k` indices.
+  * @param k The maximum number of indices to write.
+  * @return The number of indices written to `out`.
+  */
+  uint64_t fill(uint64_t * out, uint64_t k);
+  /**
   * @brief Check if all samples have been retrieved.
   *
   * This method will return `true` if all samples as defined by constructor
-  * parameter `n` have been generated. 
+  * parameter `n` have been generated.
   * @return `true` if all samples have been generated, `false` otherwise
   */
   bool end() {return _n == 0;}
-  friend class vitter_d;
+  template <typename U> friend class basic_vitter_d;
 private:
   // Functions
   uint64_t gen_skip();
+  inline uint64_t skip();
   // Data
   uint64_t _N;
   uint64_t _S;
   uint64_t _current;
   uint64_t _n;
   uint64_t _top;
+  URBG _rng;
 };
 
-} // Namespace BS
\ No newline at end of file
+/**
+* @brief Algorithm A using the default engine.
+*/
+typedef basic_vitter_a<default_engine> vitter_a;
+
+template <typename URBG>
+basic_vitter_a<URBG>::basic_vitter_a(uint64_t N, uint64_t n) :
+  basic_vitter_a(N, n, make_seeded_engine<URBG>()) {}
+
+template <typename URBG>
+basic_vitter_a<URBG>::basic_vitter_a(uint64_t N, uint64_t n, const URBG& rng) :
+  _N(N), _current(0), _n(n), _top(N - n), _rng(rng)
+{
+  if (n > N)
+    throw std::runtime_error("Cannot sample more than population without "
+                             "replacement");
+}
+
+// Steps A1-A3 without the n = 0 check. Callers guarantee _n > 0.
+template <typename URBG>
+uint64_t basic_vitter_a<URBG>::skip()
+{
+  if (_n > 1)
+  {
+    // Step A1
+    double V = uniform_open_unit(_rng);
+    // Step A2
+    uint64_t S = 0;
+    double quot = div_as_double<uint64_t>(_top, _N);
+    while (quot > V)
+    {
+      ++S;
+      --_top;
+      --_N;
+      quot = quot * div_as_double<uint64_t>(_top, _N);
+    }
+    // Step A3
+    --_N;
+    --_n;
+    _S = S;
+    return _S;
+  }
+  else
+  {
+    _S = static_cast<double>(_N) * uniform_open_unit(_rng);
+    --_n;
+    return _S;
+  }
+}
+
+template <typename URBG>
+uint64_t basic_vitter_a<URBG>::next()
+{
+  uint64_t ret = _current + gen_skip();
+  _current = ret + 1;
+  return ret;
+}
+
+template <typename URBG>
+uint64_t basic_vitter_a<URBG>::fill(uint64_t * out, uint64_t k)
+{
+  uint64_t written = 0;
+  uint64_t current = _current;
+  while (written < k && _n > 0)
+  {
+    current += skip();
+    out[written++] = current++;
+  }
+  _current = current;
+  return written;
+}
+
+template <typename URBG>
+uint64_t basic_vitter_a<URBG>::gen_skip()
+{
+  if (_n == 0)
+    throw std::runtime_error("[vitter_a::gen_skip] Tried to generate skip for "
+                             "n = 0");
+  return skip();
+}
+
+// Instantiated once in vitter_a.cpp
+extern template class basic_vitter_a<default_engine>;
+
+} // Namespace BS
@@ -1,32 +1,47 @@
 #pragma once
 
-#include "vitter_a.h"
+#include <cmath>
 #include <cstdint>
+#include <stdexcept>
+#include "aux.h"
+#include "common.h"
+#include "random.h"
+#include "vitter_a.h"
 
 namespace BS {
 
 /**
 * @brief Vitter's  algorithm D for sequential random sampling.
-* 
-* This class implements algorithm A from Vitter (1984): "Faster methods for
-* random sampling".
+*
+* This class implements algorithm D from Vitter (1984): "Faster methods for
+* random sampling". The random engine is a template parameter so it can be
+* inlined into the skip loop, see `vitter_d` for the default.
 * @cite Vitter1984
 */
-class vitter_d {
+template <typename URBG>
+class basic_vitter_d {
 public:
   /**
   * @brief Empty constructor.
   */
-  vitter_d(){}
+  basic_vitter_d(){}
   /**
   * @brief Basic constructor.
   *
   * This will instantiate the class for population size N and sample size n. The
-  * sample size n has to be less than the population N.
+  * sample size n has to be less than the population N. The engine is taken
+  * from the library random state, see `seed_random()`.
+  * @param N The size of the population
+  * @param n The sample size
+  */
+  basic_vitter_d(uint64_t N, uint64_t n);
+  /**
+  * @brief Constructor with an explicit engine.
   * @param N The size of the population
   * @param n The sample size
+  * @param rng The random engine to draw from. It is copied.
   */
-  vitter_d(uint64_t N, uint64_t n);
+  basic_vitter_d(uint64_t N, uint64_t n, const URBG& rng);
   /**
   * @brief Get next sample.
   *
@@ -36,16 +51,29 @@ public:
   */
   uint64_t next();
   /**
+  * @brief Get up to `k` next samples in one call.
+  *
+  * This method writes the sequentially next records to sample into `out`,
+  * avoiding the per-call overhead of `next()` when many indices are needed.
+  * The indices are 0 based and in increasing order. Fewer than `k` indices
+  * are written once all samples have been generated.
+  * @param out A buffer with room for at least `k` indices.
+  * @param k The maximum number of indices to write.
+  * @return The number of indices written to `out`.
+  */
+  uint64_t fill(uint64_t * out, uint64_t k);
+  /**
   * @brief Check if all samples have been retrieved.
   *
   * This method will return `true` if all samples as defined by constructor
-  * parameter `n` have been generated. 
+  * parameter `n` have been generated.
   * @return `true` if all samples have been generated, `false` otherwise
   */
   bool end() {return _n == 0;}
 private:
   // Functions
   uint64_t gen_skip();
+  inline uint64_t skip();
   void update_variables();
   // Data
   uint64_t _N;
@@ -57,7 +85,161 @@ private:
   uint64_t _quant1;
   double _quant2;
   uint64_t _threshold;
-  vitter_a _va;
+  basic_vitter_a<URBG> _va;
+  URBG _rng;
 };
 
-} // Namespace BS
\ No newline at end of file
+/**
+* @brief Algorithm D using the default engine.
+*/
+typedef basic_vitter_d<default_engine> vitter_d;
+
+template <typename URBG>
+basic_vitter_d<URBG>::basic_vitter_d(uint64_t N, uint64_t n) :
+  basic_vitter_d(N, n, make_seeded_engine<URBG>()) {}
+
+template <typename URBG>
+basic_vitter_d<URBG>::basic_vitter_d(uint64_t N, uint64_t n, const URBG& rng) :
+  _N(N), _S(0), _current(0), _init_va(false), _n(n), _rng(rng)
+{
+  if (n > N)
+    throw std::runtime_error("Cannot sample more than population without "
+                             "replacement");
+
+  _V_prime = exp(log(uniform_open_unit(_rng)) / static_cast<double>(_n));
+  _quant1 = N - n + 1;
+  _quant2 = div_as_double<uint64_t>(_quant1, N);
+  _threshold = n * VITTER_ALPHA_INV;
+}
+
+template <typename URBG>
+void basic_vitter_d<URBG>::update_variables()
+{
+  _N = _N - _S - 1;
+  --_n;
+  _quant1 = _quant1 - _S;
+  _quant2 = div_as_double<uint64_t>(_quant1, _N);
+  _threshold -= VITTER_ALPHA_INV;
+}
+
+// Steps D2-D4 without the n = 0 check. Callers guarantee _n > 0.
+template <typename URBG>
+uint64_t basic_vitter_d<URBG>::skip()
+{
+  if (_n > 1 && _threshold < _N && ! _init_va)
+  {
+    while (true)
+    {
+      double X;
+      uint64_t bottom;
+      uint64_t limit;
+      uint64_t top;
+      // Step D2
+      while (true)
+      {
+        X = static_cast<double>(_N) * (1.0 - _V_prime);
+        _S = X;
+        if (_S < _quant1)
+          break;
+        else
+          _V_prime = exp(log(uniform_open_unit(_rng)) / 
+                         static_cast<double>(_n));
+      }
+      double y = uniform_open_unit(_rng) / _quant2;
+      // Step D3
+      double lhs = exp(log(y) / static_cast<double>(_n - 1));
+      double rhs = div_as_double<uint64_t>((_quant1 - _S), _quant1) *
+                   static_cast<double>(_N) / (static_cast<double>(_N) - X);
+      if (lhs <= rhs)
+      {
+        _V_prime = lhs / rhs;
+        update_variables();
+        return _S;
+      }
+      // Step D4
+      if ((_n - 1) > _S)
+      {
+        bottom = _N - _n;
+        limit = _N - _S;
+      }
+      else
+      {
+        bottom = _N - _S - 1;
+        limit = _quant1;
+      }
+      for (top = _N - 1; top > limit; --top)
+      {
+        y *= div_as_double<uint64_t>(top, bottom);
+        --bottom;
+      }
+      if (exp(log(y) / static_cast<double>(_n - 1)) <=
+          static_cast<double>(_N) / (static_cast<double>(_N) - X))
+      {
+        _V_prime = exp(log(uniform_open_unit(_rng)) /
+                       static_cast<double>(_n - 1));
+        update_variables();
+        return _S;
+      }
+      _V_prime = exp(log(uniform_open_unit(_rng)) / static_cast<double>(_n));
+    }
+  }
+  // If we're not at the last element, we finish off the sampling using
+  // method A. Once switched, method A also draws the last element since _V_prime
+  // is no longer maintained.
+  else if (_n > 1 || _init_va)
+  {
+    if (! _init_va)
+    {
+      _va = basic_vitter_a<URBG>(_N, _n, _rng);
+      _init_va = true;
+    }
+    _S = _va.gen_skip();
+    _n = _va._n;
+    _N = _va._N;
+    return _S;
+  }
+  else // (_n == 1)
+  {
+    _S = (static_cast<double>(_N) * _V_prime);
+    update_variables();
+    return _S;
+  }
+}
+
+template <typename URBG>
+uint64_t basic_vitter_d<URBG>::gen_skip()
+{
+  if (_n == 0)
+  {
+    throw std::runtime_error("[vitter_d::gen_skip] Tried to generate skip for "
+                             "n = 0");
+  }
+  return skip();
+}
+
+template <typename URBG>
+uint64_t basic_vitter_d<URBG>::next()
+{
+  uint64_t ret = _current + gen_skip();
+  _current = ret + 1;
+  return ret;
+}
+
+template <typename URBG>
+uint64_t basic_vitter_d<URBG>::fill(uint64_t * out, uint64_t k)
+{
+  uint64_t written = 0;
+  uint64_t current = _current;
+  while (written < k && _n > 0)
+  {
+    current += skip();
+    out[written++] = current++;
+  }
+  _current = current;
+  return written;
+}
+
+// Instantiated once in vitter_d.cpp
+extern template class basic_vitter_d<default_engine>;
+
+} // Namespace BS
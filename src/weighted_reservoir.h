@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "random.h"
+
+namespace BS {
+
+/**
+* @brief Weighted reservoir sampling of a stream of unknown length.
+*
+* This class implements algorithm A-ExpJ from Efraimidis and Spirakis (2006):
+* "Weighted random sampling with a reservoir". Every kept record carries the
+* key `u^(1/w)` and the reservoir is a min-heap over the keys. Rather than
+* drawing a key for every record, the algorithm draws how much weight can pass
+* before the next insertion, so the RNG is consulted O(k log(n/k)) times.
+*
+* Keys are held as logarithms so that they do not collapse to 1 on long
+* streams.
+* @cite Efraimidis2006
+*/
+template <typename T, typename URBG = default_engine>
+class weighted_reservoir_sample {
+public:
+  /**
+  * @brief Basic constructor.
+  *
+  * The engine is taken from the library random state, see `seed_random()`.
+  * @param k The reservoir size.
+  */
+  weighted_reservoir_sample(uint64_t k);
+  /**
+  * @brief Constructor with an explicit engine.
+  * @param k The reservoir size.
+  * @param rng The random engine to draw from. It is copied.
+  */
+  weighted_reservoir_sample(uint64_t k, const URBG& rng);
+  /**
+  * @brief Offer the next record of the stream.
+  *
+  * Records with weight 0 are never sampled.
+  * @param x The record.
+  * @param w The weight of the record, which must not be negative.
+  * @return `true` if the record was placed in the reservoir, `false`
+  * otherwise.
+  */
+  inline bool add(const T& x, double w);
+  /**
+  * @brief Get the total weight which will pass before the next insertion.
+  *
+  * While the reservoir is filling this is `0`.
+  * @return The remaining weight of the current jump.
+  */
+  inline double skip_weight() const { return _X; }
+  /**
+  * @brief Get the sampled records.
+  *
+  * The records are in no particular order.
+  * @return A vector of the sampled records.
+  */
+  inline std::vector<T> sample() const;
+  /**
+  * @brief Get the number of records currently held.
+  * @return The number of records in the reservoir.
+  */
+  inline uint64_t size() const { return _heap.size(); }
+  /**
+  * @brief Get the reservoir size.
+  * @return The maximum number of records held.
+  */
+  inline uint64_t capacity() const { return _k; }
+  /**
+  * @brief Get the number of records seen so far.
+  * @return The stream length so far.
+  */
+  inline uint64_t seen() const { return _seen; }
+private:
+  typedef std::pair<double, T> entry_t;
+  static bool _key_gt(const entry_t& lhs, const entry_t& rhs)
+  {
+    return lhs.first > rhs.first;
+  }
+  void _gen_jump();
+  //
+  std::vector<entry_t> _heap;
+  uint64_t _k;
+  uint64_t _seen;
+  double _X;
+  URBG _rng;
+};
+
+template <typename T, typename URBG>
+weighted_reservoir_sample<T, URBG>::weighted_reservoir_sample(uint64_t k) :
+  weighted_reservoir_sample(k, make_seeded_engine<URBG>()) {}
+
+template <typename T, typename URBG>
+weighted_reservoir_sample<T, URBG>::weighted_reservoir_sample(uint64_t k,
+                                                              const URBG& rng) :
+  _k(k), _seen(0), _X(0), _rng(rng)
+{
+  if (k == 0)
+    throw std::runtime_error("[BS::weighted_reservoir_sample::"
+                             "weighted_reservoir_sample] Reservoir size must "
+                             "be > 0");
+  _heap.reserve(k);
+}
+
+template <typename T, typename URBG>
+void weighted_reservoir_sample<T, URBG>::_gen_jump()
+{
+  // X = log(r) / log(T_w), with the smallest key T_w on top of the heap
+  _X = std::log(uniform_open_unit(_rng)) / _heap.front().first;
+}
+
+template <typename T, typename URBG>
+bool weighted_reservoir_sample<T, URBG>::add(const T& x, double w)
+{
+  if (w < 0)
+    throw std::runtime_error("[BS::weighted_reservoir_sample::add] Negative "
+                             "weight " + std::to_string(w));
+  ++_seen;
+  if (w == 0)
+    return false;
+  if (_heap.size() < _k)
+  {
+    _heap.emplace_back(std::log(uniform_open_unit(_rng)) / w, x);
+    std::push_heap(_heap.begin(), _heap.end(), _key_gt);
+    if (_heap.size() == _k)
+      _gen_jump();
+    return true;
+  }
+  _X -= w;
+  if (_X > 0)
+    return false;
+  // The new key is drawn from (T_w^w, 1). With t = T_w^w this is
+  // r = 1 - (1 - t) * (1 - u), evaluated in log space.
+  double one_minus_t = - std::expm1(w * _heap.front().first);
+  double log_key = std::log1p(- one_minus_t * uniform_open_unit(_rng)) / w;
+  std::pop_heap(_heap.begin(), _heap.end(), _key_gt);
+  _heap.back() = entry_t(log_key, x);
+  std::push_heap(_heap.begin(), _heap.end(), _key_gt);
+  _gen_jump();
+  return true;
+}
+
+template <typename T, typename URBG>
+std::vector<T> weighted_reservoir_sample<T, URBG>::sample() const
+{
+  std::vector<T> ret;
+  ret.reserve(_heap.size());
+  for (const auto& e : _heap)
+    ret.push_back(e.second);
+  return ret;
+}
+
+} // Namespace BS
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "skiplist.h"
+
+namespace BS {
+
+/**
+* @brief Descriptive statistics over a sliding window of a stream.
+*
+* The window holds the last `max_count` values and, when timestamps are given,
+* only those at most `max_age` older than the newest one. Values leaving the
+* window are evicted in O(1) amortized time:
+*
+* - The mean and variance are updated by reversing Welford's recurrence, and
+*   recomputed from the window in two passes once as many values were evicted
+*   as the window holds, so rounding errors cannot build up over long streams
+*   at an amortized O(1) cost.
+* - Min and max are the fronts of monotonic deques.
+* - Quantiles, if enabled, come from an indexable `skiplist` in O(log n).
+*/
+template <typename T>
+class window_stats {
+public:
+  /**
+  * @brief Basic constructor.
+  * @param max_count The maximum number of values in the window.
+  * @param max_age The maximum age of values, in the unit of the timestamps
+  * given to `add()`. Infinite by default, i.e. a count window.
+  * @param quantiles Keep the values sorted for `quantile()`, which costs
+  * O(log n) per value added.
+  */
+  window_stats(uint64_t max_count,
+               double max_age = std::numeric_limits<double>::infinity(),
+               bool quantiles = true);
+  window_stats(const window_stats& other);
+  window_stats(window_stats&& other) = default;
+  window_stats& operator=(const window_stats& other);
+  window_stats& operator=(window_stats&& other) = default;
+  /**
+  * @brief Add a value without a timestamp.
+  * @param x The value.
+  */
+  inline void add(T x) { add(x, 0); }
+  /**
+  * @brief Add a value and evict values older than `max_age` before `t`.
+  * @param x The value.
+  * @param t The timestamp, not smaller than earlier ones.
+  */
+  inline void add(T x, double t);
+  /**
+  * @brief Evict values older than `max_age` before `t` without adding one.
+  * @param t The current time.
+  */
+  inline void expire(double t);
+  /**
+  * @brief Retrieve the number of values in the window.
+  * @return The number of values.
+  */
+  inline uint64_t size() const { return _window.size(); }
+  inline uint64_t count() const { return size(); }
+  /**
+  * @brief Retrieve the sum of the window.
+  * @return The sum of the window.
+  */
+  inline double sum() const { return _mean * static_cast<double>(size()); }
+  /**
+  * @brief Retrieve the mean of the window.
+  * @return The mean of the window.
+  */
+  inline double mean() const { return _mean; }
+  /**
+  * @brief Retrieve the sample variance of the window.
+  * @return The variance of the window.
+  */
+  inline double variance() const
+  {
+    // Rounding since the last recomputation can leave _M2 a few ulps below 0
+    return size() > 1 ? std::max(0.0, _M2) / static_cast<double>(size() - 1) :
+                        std::numeric_limits<double>::quiet_NaN();
+  }
+  /**
+  * @brief Retrieve the sample standard deviation of the window.
+  * @return The standard deviation of the window.
+  */
+  inline double stddev() const { return std::sqrt(variance()); }
+  /**
+  * @brief Retrieve the min of the window.
+  * @return The min of the window.
+  */
+  inline T min() const;
+  /**
+  * @brief Retrieve the max of the window.
+  * @return The max of the window.
+  */
+  inline T max() const;
+  /**
+  * @brief Retrieve the value at a given quantile, see
+  * `desc_stats::quantile()`.
+  * @param q The quantile as a fraction, e.g.: `0.5` for Q50.
+  * @return The value of the window at the given quantile.
+  */
+  inline double quantile(const double q) const;
+  /**
+  * @brief Retrieve the median of the window.
+  * @return The median of the window.
+  */
+  inline double median() const { return quantile(0.5); }
+private:
+  struct entry
+  {
+    entry(T v, double ts, uint64_t s) : x(v), t(ts), seq(s) {}
+    T x;
+    double t;
+    uint64_t seq;
+  };
+  inline void _evict();
+  inline void _recompute();
+  //
+  uint64_t _max_count;
+  double _max_age;
+  uint64_t _seq;
+  std::deque<entry> _window;
+  // Increasing and decreasing values, fronts are the min and max
+  std::deque<entry> _mins;
+  std::deque<entry> _maxs;
+  double _mean;
+  double _M2;
+  // Evictions since _mean and _M2 were last recomputed
+  uint64_t _evicted;
+  // Only allocated when quantiles are enabled
+  std::unique_ptr<skiplist<T>> _sorted;
+};
+
+template <typename T>
+window_stats<T>::window_stats(uint64_t max_count, double max_age,
+                              bool quantiles) :
+  _max_count(max_count), _max_age(max_age), _seq(0), _mean(0), _M2(0),
+  _evicted(0)
+{
+  if (max_count == 0)
+  {
+    throw std::runtime_error("[BS::window_stats::window_stats] Window size "
+                             "must be positive");
+  }
+  if (quantiles)
+    _sorted.reset(new skiplist<T>());
+}
+
+template <typename T>
+window_stats<T>::window_stats(const window_stats& other) :
+  _max_count(other._max_count), _max_age(other._max_age), _seq(other._seq),
+  _window(other._window), _mins(other._mins), _maxs(other._maxs),
+  _mean(other._mean), _M2(other._M2), _evicted(other._evicted),
+  _sorted(other._sorted ? new skiplist<T>(*other._sorted) : nullptr) {}
+
+template <typename T>
+window_stats<T>& window_stats<T>::operator=(const window_stats& other)
+{
+  window_stats copy(other);
+  *this = std::move(copy);
+  return *this;
+}
+
+template <typename T>
+void window_stats<T>::add(T x, double t)
+{
+  if (_window.size() == _max_count)
+    _evict();
+  entry e(x, t, _seq++);
+  _window.push_back(e);
+  while (! _mins.empty() && ! (_mins.back().x < x))
+    _mins.pop_back();
+  _mins.push_back(e);
+  while (! _maxs.empty() && ! (x < _maxs.back().x))
+    _maxs.pop_back();
+  _maxs.push_back(e);
+  double xd = static_cast<double>(x);
+  double delta = xd - _mean;
+  _mean += delta / static_cast<double>(_window.size());
+  _M2 += delta * (xd - _mean);
+  if (_sorted)
+    _sorted->insert(x);
+  expire(t);
+}
+
+template <typename T>
+void window_stats<T>::expire(double t)
+{
+  while (! _window.empty() && t - _window.front().t > _max_age)
+    _evict();
+}
+
+template <typename T>
+void window_stats<T>::_evict()
+{
+  const entry& e = _window.front();
+  if (_mins.front().seq == e.seq)
+    _mins.pop_front();
+  if (_maxs.front().seq == e.seq)
+    _maxs.pop_front();
+  // Welford's update run backwards
+  double xd = static_cast<double>(e.x);
+  uint64_t n = _window.size() - 1;
+  if (n == 0)
+  {
+    _mean = 0;
+    _M2 = 0;
+  }
+  else
+  {
+    double delta = xd - _mean;
+    _mean -= delta / static_cast<double>(n);
+    _M2 -= delta * (xd - _mean);
+  }
+  if (_sorted)
+    _sorted->erase(e.x);
+  _window.pop_front();
+  if (++_evicted >= _window.size())
+    _recompute();
+}
+
+template <typename T>
+void window_stats<T>::_recompute()
+{
+  _evicted = 0;
+  _mean = 0;
+  _M2 = 0;
+  if (_window.empty())
+    return;
+  double n = static_cast<double>(_window.size());
+  double sum = 0;
+  for (const entry& e : _window)
+    sum += static_cast<double>(e.x);
+  double mean = sum / n;
+  // Two passes, with the sum of deviations correcting the rounding of mean
+  double dev = 0;
+  double dev2 = 0;
+  for (const entry& e : _window)
+  {
+    double d = static_cast<double>(e.x) - mean;
+    dev += d;
+    dev2 += d * d;
+  }
+  _mean = mean + dev / n;
+  _M2 = dev2 - dev * dev / n;
+}
+
+template <typename T>
+T window_stats<T>::min() const
+{
+  if (_window.empty())
+  {
+    throw std::runtime_error("[BS::window_stats::min] No data");
+  }
+  return _mins.front().x;
+}
+
+template <typename T>
+T window_stats<T>::max() const
+{
+  if (_window.empty())
+  {
+    throw std::runtime_error("[BS::window_stats::max] No data");
+  }
+  return _maxs.front().x;
+}
+
+template <typename T>
+double window_stats<T>::quantile(const double q) const
+{
+  if (q < 0 || q > 1)
+  {
+    throw std::runtime_error("[BS::window_stats::quantile]\t Probability must "
+                             "be between 0 and 1");
+  }
+  if (! _sorted)
+  {
+    throw std::runtime_error("[BS::window_stats::quantile] Quantiles are "
+                             "disabled");
+  }
+  if (_window.empty())
+  {
+    throw std::runtime_error("[BS::window_stats::quantile] No data");
+  }
+  // Hyndman-Fan type 7, as desc_stats::quantile()
+  double h = q * static_cast<double>(_sorted->size() - 1);
+  uint64_t i0 = static_cast<uint64_t>(std::floor(h));
+  double x0 = static_cast<double>(_sorted->at(i0));
+  if (i0 + 1 >= _sorted->size() || h == std::floor(h))
+    return x0;
+  double x1 = static_cast<double>(_sorted->at(i0 + 1));
+  return x0 + (h - std::floor(h)) * (x1 - x0);
+}
+
+} // Namespace BS
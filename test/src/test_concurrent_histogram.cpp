@@ -0,0 +1,96 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/concurrent_histogram.h"
+#include "../../src/histogram.h"
+#include "../../src/random.h"
+
+static uint64_t total(const std::vector<uint64_t>& counts)
+{
+  uint64_t sum = 0;
+  for (uint64_t c : counts)
+    sum += c;
+  return sum;
+}
+
+// Add from several threads while another one takes snapshots, then check the
+// final counts against a serial histogram
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    uint32_t threads = argc > 2 ? std::stoul(argv[2]) : 8;
+    const uint32_t bins = 50;
+
+    BS::default_engine rng(5);
+    std::vector<double> data(n);
+    for (auto& x : data)
+      x = 1000 * BS::uniform_open_unit(rng) * BS::uniform_open_unit(rng);
+    BS::histogram<double> serial(data, 0, 1000, bins);
+
+    BS::concurrent_histogram<double> ch(0, 1000, bins);
+    std::atomic<bool> done(false);
+    int reader_ret = 0;
+    std::thread reader([&]()
+    {
+      uint64_t last = 0;
+      std::vector<uint64_t> last_counts(bins, 0);
+      while (! done.load())
+      {
+        BS::histogram<double> h = ch.snapshot();
+        if (h.const_breaks() != serial.const_breaks())
+          reader_ret = __LINE__;
+        for (uint32_t b = 0; b < bins; b++)
+        {
+          if (h.const_counts()[b] < last_counts[b])
+            reader_ret = __LINE__;
+        }
+        last_counts = h.const_counts();
+        last = total(last_counts);
+        if (last > n)
+          reader_ret = __LINE__;
+      }
+    });
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> writers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+      writers.emplace_back([&, t]()
+      {
+        for (uint64_t i = t; i < n; i += threads)
+          ch.add(data[i]);
+      });
+    }
+    for (auto& th : writers)
+      th.join();
+    std::chrono::duration<double> t_add =
+      std::chrono::steady_clock::now() - start;
+    done.store(true);
+    reader.join();
+    std::cout << threads << " threads, " << ch.stripes() << " stripes:\t"
+              << n / t_add.count() << " values/sec\n";
+    if (reader_ret)
+      return reader_ret;
+    BS::histogram<double> final_counts = ch.snapshot();
+    if (final_counts.const_counts() != serial.const_counts())
+      return __LINE__;
+    try  // Should fail
+    {
+      ch.add(1001);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "../../src/count_table.h"
+#include "../../src/describe.h"
+#include "../../src/histogram.h"
+#include "../../src/random.h"
+
+// Counts mode must answer exactly like full mode
+template <typename T>
+static bool same(const std::vector<T>& data)
+{
+  const std::vector<double> probs {0, 0.001, 0.05, 0.25, 0.5, 0.75, 0.95,
+                                   0.999, 1};
+  BS::desc_stats<T> full(data, BS::stats_mode::full);
+  BS::desc_stats<T> counts(data);
+  if (counts.mode() != BS::stats_mode::counts)
+    return false;
+  if (counts.quantiles(probs) != full.quantiles(probs) ||
+      counts.min() != full.min() || counts.max() != full.max() ||
+      counts.count() != full.count())
+    return false;
+  BS::histogram<T> hf(full, 20);
+  BS::histogram<T> hc(counts, 20);
+  return hf.const_counts() == hc.const_counts();
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    BS::default_engine rng(31);
+
+    // Coverage depths: a narrow range, kept dense
+    std::vector<uint32_t> depth(n);
+    for (auto& x : depth)
+      x = static_cast<uint32_t>(std::max(0.0, 70 + 10 * std::log(
+                                BS::uniform_open_unit(rng)) +
+                                20 * BS::uniform_open_unit(rng)));
+    BS::count_table<uint32_t> dense;
+    for (auto x : depth) dense.add(x);
+    std::cout << "depth:\t" << n << " values\t" << dense.distinct()
+              << " distinct\t" << dense.memory_bytes() << " bytes\t"
+              << (dense.dense() ? "dense" : "sparse") << '\n';
+    if (! dense.dense() || ! same(depth))
+    {
+      return __LINE__;
+    }
+
+    // Read lengths spread over a wide range, kept sparse
+    std::vector<uint64_t> lengths(n);
+    for (auto& x : lengths)
+      x = static_cast<uint64_t>(std::exp(20 * BS::uniform_open_unit(rng))) / 100;
+    BS::count_table<uint64_t> sparse;
+    for (auto x : lengths) sparse.add(x);
+    std::cout << "lengths:\t" << n << " values\t" << sparse.distinct()
+              << " distinct\t" << sparse.memory_bytes() << " bytes\t"
+              << (sparse.dense() ? "dense" : "sparse") << '\n';
+    if (sparse.dense() || ! same(lengths))
+    {
+      return __LINE__;
+    }
+
+    // Signed values and extremes, growing downwards
+    std::vector<int64_t> extremes {5, -3, 0, -3, 7,
+                                   std::numeric_limits<int64_t>::min() / 2,
+                                   std::numeric_limits<int64_t>::max() / 2};
+    std::vector<int> descending;
+    for (int i = 100000; i > -100000; i--)
+      descending.push_back(i % 1000 - 1000);
+    if (! same(extremes) || ! same(descending))
+    {
+      return __LINE__;
+    }
+
+    // Merging tables
+    BS::desc_stats<uint32_t> a;
+    BS::desc_stats<uint32_t> b;
+    for (uint64_t i = 0; i < depth.size(); i++)
+      (i % 2 ? a : b).add(depth[i]);
+    a += b;
+    BS::desc_stats<uint32_t> full(depth, BS::stats_mode::full);
+    if (a.median() != full.median() || a.quantile(0.99) != full.quantile(0.99))
+    {
+      return __LINE__;
+    }
+
+    // Moving a vector in picks the same mode as copying it
+    std::vector<uint32_t> owned(depth);
+    BS::desc_stats<uint32_t> moved(std::move(owned));
+    if (moved.mode() != BS::stats_mode::counts || ! owned.empty() ||
+        moved.median() != full.median() || moved.count() != full.count())
+    {
+      return __LINE__;
+    }
+    owned = depth;
+    BS::desc_stats<uint32_t> kept(std::move(owned), BS::stats_mode::full);
+    if (kept.mode() != BS::stats_mode::full || kept.median() != full.median())
+    {
+      return __LINE__;
+    }
+
+    // A few values over a wide range are not kept in a dense array
+    BS::count_table<int> few;
+    for (int x : {0, 500000, 1000000})
+      few.add(x);
+    if (few.dense() || few.memory_bytes() > 4096)
+    {
+      return __LINE__;
+    }
+
+    try  // Should fail, not an integer type
+    {
+      BS::desc_stats<double> bad(BS::stats_mode::counts);
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
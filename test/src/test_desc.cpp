@@ -1,5 +1,8 @@
 #include <vector>
 #include <iostream>
+#include <utility>
+#include <algorithm>
+#include <cmath>
 
 #include "../../src/describe.h"
 #include "../../src/common.h"
@@ -34,5 +37,196 @@ int main(int argc, char ** argv)
 
   std::cerr << desc.quantile(0.49) << '\n';
 
+  // Moments against a two pass computation
+  data.push_back(1);
+  double n = static_cast<double>(data.size());
+  double mean = 0;
+  for (double d : data) mean += d;
+  mean /= n;
+  double m2 = 0;
+  double m3 = 0;
+  double m4 = 0;
+  for (double d : data)
+  {
+    m2 += std::pow(d - mean, 2);
+    m3 += std::pow(d - mean, 3);
+    m4 += std::pow(d - mean, 4);
+  }
+  double var = m2 / (n - 1);
+  double skew = std::sqrt(n) * m3 / std::pow(m2, 1.5);
+  double kurt = n * m4 / (m2 * m2) - 3;
+  if (std::fabs(desc.mean() - mean) > 1e-12 ||
+      std::fabs(desc.variance() - var) > 1e-12 ||
+      std::fabs(desc.skewness() - skew) > 1e-12 ||
+      std::fabs(desc.kurtosis() - kurt) > 1e-12)
+  {
+    std::cerr << desc.mean() << '\t' << desc.variance() << '\t'
+              << desc.skewness() << '\t' << desc.kurtosis() << '\n';
+    return __LINE__;
+  }
+
+  // Online mode keeps no data but has the same moments
+  BS::desc_stats<double> online(BS::stats_mode::online);
+  for (double d : data) online.add(d);
+  if (online.count() != data.size() ||
+      ! BS::almost_eq<double>(online.min(), 0) ||
+      ! BS::almost_eq<double>(online.max(), 1) ||
+      std::fabs(online.mean() - mean) > 1e-12 ||
+      std::fabs(online.stddev() - std::sqrt(var)) > 1e-12 ||
+      std::fabs(online.kurtosis() - kurt) > 1e-12)
+  {
+    return __LINE__;
+  }
+  try  // Should fail
+  {
+    online.median();
+    return __LINE__;
+  }
+  catch(std::exception& e)
+  {
+  }
+
+  // Sums of doubles are not truncated
+  std::vector<double> halves {0.5, 0.5, 0.5};
+  BS::desc_stats<double> hdesc(halves);
+  if (! BS::almost_eq<double>(hdesc.sum(), 1.5) ||
+      ! BS::almost_eq<double>(hdesc.mean(), 0.5))
+  {
+    return __LINE__;
+  }
+
+  // Multi-select quantiles match the sorted path, including repeated and
+  // extreme probabilities
+  std::vector<double> probs {0.5, 0.05, 0.1, 0.25, 0.75, 0.9, 0.95, 0, 1, 0.5,
+                             0.49, 0.333};
+  std::vector<double> shuffled;
+  for (uint64_t i = 0; i < 1001; i++)
+  {
+    shuffled.push_back(static_cast<double>((i * 7919) % 1001) / 7.0);
+  }
+  BS::desc_stats<double> select(shuffled);
+  BS::desc_stats<double> sorted(shuffled);
+  std::vector<double> got = select.quantiles(probs);
+  for (uint64_t i = 0; i < probs.size(); i++)
+  {
+    if (got[i] != sorted.quantile(probs[i]))
+    {
+      std::cerr << probs[i] << '\t' << got[i] << '\t'
+                << sorted.quantile(probs[i]) << '\n';
+      return __LINE__;
+    }
+  }
+  // Once sorted, the sorted path gives the same answers
+  got = sorted.quantiles(probs);
+  for (uint64_t i = 0; i < probs.size(); i++)
+  {
+    if (got[i] != sorted.quantile(probs[i]))
+    {
+      return __LINE__;
+    }
+  }
+  try  // Should fail
+  {
+    online.quantiles(probs);
+    return __LINE__;
+  }
+  catch(std::exception& e)
+  {
+  }
+
+  // Moving a vector in takes its buffer without a copy
+  std::vector<double> owned(shuffled);
+  BS::desc_stats<double> moved(std::move(owned));
+  if (moved.count() != shuffled.size() ||
+      moved.median() != sorted.median() || moved.is_view())
+  {
+    return __LINE__;
+  }
+
+  // Mutable view: sorted in place, no copy
+  std::vector<double> buf(shuffled);
+  BS::desc_stats<double> view(buf.data(), buf.size());
+  if (! view.is_view() || view.count() != shuffled.size() ||
+      view.quantiles(probs) != sorted.quantiles(probs) ||
+      view.median() != sorted.median() ||
+      ! std::is_sorted(buf.begin(), buf.end()) ||
+      std::fabs(view.mean() - sorted.mean()) > 1e-12)
+  {
+    return __LINE__;
+  }
+  try  // Should fail
+  {
+    view.add(1);
+    return __LINE__;
+  }
+  catch(std::exception& e)
+  {
+  }
+
+  // Read-only view over sorted data
+  const std::vector<double> sorted_buf(buf);
+  BS::desc_stats<double> ro(sorted_buf.data(), sorted_buf.size());
+  if (ro.median() != sorted.median() || ro.max() != sorted.max())
+  {
+    return __LINE__;
+  }
+  // Views can be merged into owning objects
+  BS::desc_stats<double> owner(shuffled);
+  owner += ro;
+  if (owner.count() != 2 * shuffled.size() ||
+      owner.median() != sorted.median())
+  {
+    return __LINE__;
+  }
+  try  // Should fail, not sorted
+  {
+    const std::vector<double> unsorted {2, 1};
+    BS::desc_stats<double> bad(unsorted.data(), unsorted.size());
+    return __LINE__;
+  }
+  catch(std::exception& e)
+  {
+  }
+
+  // Interleaved adds and queries only sort the added tail
+  BS::desc_stats<double> growing;
+  std::vector<double> seen;
+  for (uint64_t i = 0; i < shuffled.size(); i++)
+  {
+    growing.add(shuffled[i]);
+    seen.push_back(shuffled[i]);
+    if (i % 97 == 0)
+    {
+      BS::desc_stats<double> fresh(seen);
+      if (growing.quantiles(probs) != fresh.quantiles(probs))
+      {
+        return __LINE__;
+      }
+    }
+  }
+
+  // Indexed mode answers like full mode
+  BS::desc_stats<double> indexed(BS::stats_mode::indexed);
+  for (double d : shuffled) indexed.add(d);
+  if (indexed.quantiles(probs) != sorted.quantiles(probs) ||
+      indexed.median() != sorted.median() ||
+      indexed.count() != shuffled.size())
+  {
+    return __LINE__;
+  }
+  BS::desc_stats<double> indexed2(BS::stats_mode::indexed);
+  indexed2.add(-1);
+  indexed2 += indexed;
+  if (indexed2.quantile(0) != -1 || indexed2.count() != shuffled.size() + 1)
+  {
+    return __LINE__;
+  }
+  BS::histogram<double> ih(indexed, 10);
+  BS::histogram<double> sh(sorted, 10);
+  if (ih.const_counts() != sh.const_counts())
+  {
+    return __LINE__;
+  }
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "../../src/fastq_sampler.h"
+
+static void write_fastq(const std::string& path, uint64_t N, const char * mate)
+{
+  gzFile gz = gzopen(path.c_str(), "wb");
+  for (uint64_t i = 0; i < N; i++)
+  {
+    gzprintf(gz, "@read%llu/%s\nACGTACGT\n+\nIIIIIIII\n",
+             static_cast<unsigned long long>(i), mate);
+  }
+  gzclose(gz);
+}
+
+// Both outputs must hold n records with the same, increasing read ids
+static int check(const std::string& r1, const std::string& r2, uint64_t n)
+{
+  std::istringstream s1(r1);
+  std::istringstream s2(r2);
+  std::string l1;
+  std::string l2;
+  uint64_t records = 0;
+  int64_t prev = -1;
+  for (uint64_t line = 0; std::getline(s1, l1); line++)
+  {
+    if (! std::getline(s2, l2))
+    {
+      return __LINE__;
+    }
+    if (line % 4 != 0)
+    {
+      continue;
+    }
+    std::string id1 = l1.substr(0, l1.find('/'));
+    std::string id2 = l2.substr(0, l2.find('/'));
+    if (id1 != id2)
+    {
+      std::cerr << id1 << " != " << id2 << '\n';
+      return __LINE__;
+    }
+    int64_t id = std::stol(id1.substr(5));
+    if (id <= prev)
+    {
+      return __LINE__;
+    }
+    prev = id;
+    records++;
+  }
+  if (records != n)
+  {
+    std::cerr << records << " records, expected " << n << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
+
+int main(int argc, char ** argv)
+{
+  uint64_t N = 100000;
+  std::string p1("test_fastq_sampler_R1.fq.gz");
+  std::string p2("test_fastq_sampler_R2.fq.gz");
+  try
+  {
+    write_fastq(p1, N, "1");
+    write_fastq(p2, N, "2");
+    BS::fastq_sampler fs({p1, p2});
+
+    // Known number of records
+    std::ostringstream o1;
+    std::ostringstream o2;
+    if (fs.sample(1000, N, {&o1, &o2}) != 1000)
+    {
+      return __LINE__;
+    }
+    int err = check(o1.str(), o2.str(), 1000);
+    if (err) return err;
+
+    // Unknown number of records
+    std::ostringstream r1;
+    std::ostringstream r2;
+    if (fs.sample(1000, {&r1, &r2}) != 1000)
+    {
+      return __LINE__;
+    }
+    err = check(r1.str(), r2.str(), 1000);
+    if (err) return err;
+
+    // More records requested than present
+    std::ostringstream a1;
+    std::ostringstream a2;
+    if (fs.sample(2 * N, {&a1, &a2}) != N)
+    {
+      return __LINE__;
+    }
+
+    try // Should fail
+    {
+      std::ostringstream f1;
+      std::ostringstream f2;
+      fs.sample(10, 2 * N, {&f1, &f2});
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  std::remove(p1.c_str());
+  std::remove(p2.c_str());
+  return 0;
+}
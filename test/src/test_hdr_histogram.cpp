@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../src/hdr_histogram.h"
+#include "../../src/random.h"
+
+// Latency-like data from 1 ns to 10 s, with quantiles checked against the
+// exact order statistics to the relative error of the significant digits
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    uint32_t digits = argc > 2 ? std::stoul(argv[2]) : 3;
+    const uint64_t highest = 10000000000ULL;
+    const std::vector<double> probs {0, 0.001, 0.25, 0.5, 0.9, 0.99, 0.999,
+                                     0.9999, 1};
+
+    BS::default_engine rng(41);
+    std::vector<uint64_t> data(n);
+    for (auto& x : data)
+      x = static_cast<uint64_t>(std::pow(10.0,
+                                         10 * BS::uniform_open_unit(rng)));
+
+    BS::hdr_histogram h(1, highest, digits);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t x : data)
+      h.add(x);
+    std::chrono::duration<double> t_add =
+      std::chrono::steady_clock::now() - start;
+    std::cout << h.bins() << " bins, " << h.memory_bytes() << " bytes:\t"
+              << n / t_add.count() << " values/sec\n";
+
+    std::vector<uint64_t> sorted(data);
+    std::sort(sorted.begin(), sorted.end());
+    if (h.count() != n || h.min() != sorted.front() ||
+        h.max() != sorted.back())
+    {
+      return __LINE__;
+    }
+    double tolerance = std::pow(10.0, -static_cast<double>(digits));
+    std::vector<uint64_t> q = h.quantiles(probs);
+    for (uint64_t j = 0; j < probs.size(); j++)
+    {
+      uint64_t rank = std::max<uint64_t>(1, std::ceil(probs[j] * n));
+      double exact = static_cast<double>(sorted[rank - 1]);
+      double est = static_cast<double>(q[j]);
+      std::cout << "Q" << probs[j] * 100 << '\t' << exact << '\t' << est
+                << '\n';
+      if (est < exact || est > exact * (1 + tolerance) ||
+          q[j] != h.quantile(probs[j]))
+      {
+        return __LINE__;
+      }
+    }
+
+    // Merging two halves gives the same counts
+    BS::hdr_histogram a(1, highest, digits);
+    BS::hdr_histogram b(1, highest, digits);
+    for (uint64_t i = 0; i < n; i++)
+      (i % 2 ? a : b).add(data[i]);
+    a += b;
+    if (a.count() != n || a.quantiles(probs) != q || a.min() != h.min() ||
+        a.max() != h.max())
+    {
+      return __LINE__;
+    }
+
+    // Bins tile the range, and print_tsv covers all data
+    std::ostringstream out;
+    h.print_tsv(out);
+    std::istringstream in(out.str());
+    uint64_t lb, ub, c, prev_ub = h.lowest_equivalent(h.min()), total = 0;
+    while (in >> lb >> ub >> c)
+    {
+      if (lb != prev_ub || ub <= lb)
+        return __LINE__;
+      prev_ub = ub;
+      total += c;
+    }
+    if (total != n || prev_ub != h.highest_equivalent(h.max()) + 1)
+      return __LINE__;
+    for (uint64_t x : std::vector<uint64_t> {1, 999, 12345, 987654321, highest})
+    {
+      if (h.lowest_equivalent(x) > x || h.highest_equivalent(x) < x ||
+          h.highest_equivalent(x) - h.lowest_equivalent(x) >
+          tolerance * static_cast<double>(x))
+      {
+        return __LINE__;
+      }
+    }
+
+    try  // Should fail
+    {
+      h.add(highest + 1);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+    try  // Should fail
+    {
+      a += BS::hdr_histogram(1, highest, digits + 1);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+    try  // Should fail, the lowest value leaves no room for the digits
+    {
+      BS::hdr_histogram(1ULL << 50, 1ULL << 62, 5);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
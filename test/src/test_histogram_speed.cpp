@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../../src/common.h"
+#include "../../src/histogram.h"
+#include "../../src/random.h"
+
+// The binning histogram::add() used before arithmetic binning: a binary
+// search over the breaks
+template <typename T>
+static std::vector<uint64_t> search_counts(const BS::histogram<T>& h,
+                                           const std::vector<T>& data)
+{
+  const std::vector<T>& breaks = h.const_breaks();
+  std::vector<uint64_t> counts(h.bins(), 0);
+  for (const T& x : data)
+  {
+    auto ptr = std::lower_bound(breaks.begin(), breaks.end(), x,
+                                BS::almost_lt_eq<T>);
+    uint32_t ind = std::distance(breaks.begin(), ptr) - 1;
+    counts[std::min(ind, h.bins() - 1)]++;
+  }
+  return counts;
+}
+
+// Time the binary search, add(), bulk add() and unsafe_add(), and check that
+// all of them give the same counts. Values out of bounds only go to
+// unsafe_add(), which puts values below min in the last bin like the binary
+// search, and must make bulk add() throw without counting anything.
+template <typename T>
+static int run(const std::string& name, const std::vector<T>& data, T min,
+               T max, uint32_t bins)
+{
+  std::vector<T> in_range;
+  for (const T& x : data)
+  {
+    if (BS::almost_gt_eq<T>(x, min) && BS::almost_lt_eq<T>(x, max))
+      in_range.push_back(x);
+  }
+  BS::histogram<T> ref(min, max, bins);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<uint64_t> expected = search_counts(ref, data);
+  std::chrono::duration<double> t_search =
+    std::chrono::steady_clock::now() - start;
+
+  BS::histogram<T> safe(min, max, bins);
+  start = std::chrono::steady_clock::now();
+  for (const T& x : in_range)
+    safe.add(x);
+  std::chrono::duration<double> t_add =
+    std::chrono::steady_clock::now() - start;
+
+  BS::histogram<T> bulk(min, max, bins);
+  start = std::chrono::steady_clock::now();
+  bulk.add(in_range.data(), in_range.data() + in_range.size());
+  std::chrono::duration<double> t_bulk =
+    std::chrono::steady_clock::now() - start;
+
+  BS::histogram<T> unsafe(min, max, bins);
+  start = std::chrono::steady_clock::now();
+  for (const T& x : data)
+    unsafe.unsafe_add(x);
+  std::chrono::duration<double> t_unsafe =
+    std::chrono::steady_clock::now() - start;
+
+  double n = static_cast<double>(data.size());
+  std::cout << name << '\t' << bins << '\t' << n / t_search.count() << '\t'
+            << in_range.size() / t_add.count() << '\t'
+            << in_range.size() / t_bulk.count() << '\t'
+            << n / t_unsafe.count() << '\n';
+  if (safe.const_counts() != search_counts(ref, in_range) ||
+      bulk.const_counts() != safe.const_counts() ||
+      unsafe.const_counts() != expected)
+  {
+    return __LINE__;
+  }
+  if (in_range.size() < data.size())
+  {
+    try
+    {
+      bulk.add(data.data(), data.data() + data.size());
+      return __LINE__;
+    }
+    catch (std::runtime_error&)
+    {
+      if (bulk.const_counts() != safe.const_counts())
+        return __LINE__;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char ** argv)
+{
+  uint64_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+  uint32_t max_bins = argc > 2 ? std::stoul(argv[2]) : 1000;
+  BS::default_engine rng(37);
+  std::cout << "type\tbins\tsearch\tadd\tbulk_add\tunsafe_add\t"
+               "(values/sec)\n";
+  for (uint32_t bins = 10; bins <= max_bins; bins *= 10)
+  {
+    // Uniform values, plus values on and next to every break
+    double min = -3.7;
+    double max = 1234.5;
+    std::vector<double> data(n);
+    for (auto& x : data)
+      x = min + (max - min) * BS::uniform_open_unit(rng);
+    BS::histogram<double> h(min, max, bins);
+    for (double b : h.const_breaks())
+    {
+      data.push_back(b);
+      data.push_back(std::nextafter(b, min));
+      data.push_back(std::nextafter(b, max));
+      data.push_back(b * (1 + 2e-16));
+      data.push_back(b * (1 - 2e-16));
+    }
+    data.push_back(max);
+    data.push_back(max + 1);
+    int ret = run<double>("double", data, min, max, bins);
+    if (ret)
+      return ret;
+
+    std::vector<uint32_t> idata(n);
+    for (auto& x : idata)
+      x = static_cast<uint32_t>(rng() % 100001);
+    ret = run<uint32_t>("uint32_t", idata, 0, 100000, bins);
+    if (ret)
+      return ret;
+  }
+  // Integer breaks less than 1 apart use the binary search
+  std::vector<int> small {0, 1, 2, 3, 4, 5};
+  return run<int>("int", small, 0, 5, 50);
+}
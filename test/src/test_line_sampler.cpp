@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../../src/line_sampler.h"
+
+// Lines are "line_<i>", so every view can be checked against its position
+static int check(const std::vector<BS::line_view>& views, uint64_t n,
+                 uint64_t N)
+{
+  if (views.size() != n)
+  {
+    return __LINE__;
+  }
+  int64_t prev = -1;
+  for (const auto& v : views)
+  {
+    std::string s = v.str();
+    if (s.compare(0, 5, "line_") != 0)
+    {
+      std::cerr << "Bad line '" << s << "'\n";
+      return __LINE__;
+    }
+    int64_t i = std::stol(s.substr(5));
+    if (i <= prev || i >= static_cast<int64_t>(N))
+    {
+      std::cerr << "Line " << i << " out of order or range\n";
+      return __LINE__;
+    }
+    prev = i;
+  }
+  return 0;
+}
+
+int main(int argc, char ** argv)
+{
+  std::string path("test_line_sampler.txt");
+  std::string index_path("test_line_sampler.idx");
+  std::string other_path("test_line_sampler_other.txt");
+  uint64_t N = 100000;
+  try
+  {
+    {
+      std::ofstream out(path.c_str());
+      for (uint64_t i = 0; i < N; i++)
+      {
+        out << "line_" << i;
+        // No newline after the last line
+        if (i < N - 1) out << '\n';
+      }
+    }
+
+    BS::line_sampler ls(path, 100);
+    if (ls.lines() != N)
+    {
+      std::cerr << ls.lines() << " lines, expected " << N << '\n';
+      return __LINE__;
+    }
+    if (ls.line(12345).str() != "line_12345" ||
+        ls.line(N - 1).str() != "line_" + std::to_string(N - 1))
+    {
+      return __LINE__;
+    }
+    int err = check(ls.sample(1000), 1000, N);
+    if (err) return err;
+    err = check(ls.sample(N), N, N);
+    if (err) return err;
+
+    ls.save_index(index_path);
+    BS::line_sampler ls2(path);
+    if (! ls2.load_index(index_path) || ls2.lines() != N)
+    {
+      return __LINE__;
+    }
+    err = check(ls2.sample(10), 10, N);
+    if (err) return err;
+
+    try // Should fail
+    {
+      ls.line(N);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+
+    // An index whose offsets point past the end of the file
+    {
+      std::ifstream in(index_path.c_str(), std::ios::binary);
+      std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+      // Offsets follow the magic and five 8 byte header fields
+      uint64_t bad = 1ULL << 40;
+      std::copy(reinterpret_cast<char *>(&bad),
+                reinterpret_cast<char *>(&bad) + sizeof(bad),
+                bytes.begin() + 48 + 5 * sizeof(uint64_t));
+      std::ofstream out(index_path.c_str(), std::ios::binary);
+      out.write(bytes.data(), bytes.size());
+    }
+    try // Should fail
+    {
+      BS::line_sampler ls3(path);
+      ls3.load_index(index_path);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+    // An index written for another file
+    {
+      std::ofstream out(other_path.c_str());
+      out << "line_0\nline_1\n";
+    }
+    BS::line_sampler other(other_path);
+    other.save_index(index_path);
+    try // Should fail
+    {
+      BS::line_sampler ls4(path);
+      ls4.load_index(index_path);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  std::remove(path.c_str());
+  std::remove(index_path.c_str());
+  std::remove(other_path.c_str());
+  return 0;
+}
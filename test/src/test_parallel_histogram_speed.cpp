@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/histogram.h"
+#include "../../src/parallel_stats.h"
+#include "../../src/random.h"
+
+// Time parallel_histogram() for 1, 2, 4, ... threads up to a maximum, and
+// check that every thread count gives the counts of the serial constructor
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 100000000;
+    uint32_t max_threads = argc > 2 ? std::stoul(argv[2]) : 64;
+    uint32_t bins = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    BS::default_engine rng(23);
+    std::vector<double> data(n);
+    for (auto& x : data)
+      x = std::exp(4 * BS::uniform_open_unit(rng));
+
+    auto start = std::chrono::steady_clock::now();
+    BS::histogram<double> serial(data, bins);
+    std::chrono::duration<double> t_serial =
+      std::chrono::steady_clock::now() - start;
+    std::cout << "threads\tseconds\tvalues/sec\tspeedup\n";
+    std::cout << "serial\t" << t_serial.count() << '\t'
+              << n / t_serial.count() << "\t1\n";
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+      start = std::chrono::steady_clock::now();
+      BS::histogram<double> par =
+        BS::parallel_histogram(data.data(), n, bins, threads);
+      std::chrono::duration<double> t_par =
+        std::chrono::steady_clock::now() - start;
+      std::cout << threads << '\t' << t_par.count() << '\t'
+                << n / t_par.count() << '\t'
+                << t_serial.count() / t_par.count() << '\n';
+      if (par.const_counts() != serial.const_counts() ||
+          par.const_breaks() != serial.const_breaks())
+      {
+        return __LINE__;
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/hypergeometric.h"
+#include "../../src/parallel_sample.h"
+#include "../../src/random.h"
+#include "../../src/vitter_d.h"
+
+// Mean and variance of the number of good items in a sample
+static void hyper_moments(double good, double bad, double sample,
+                          double& mean, double& var)
+{
+  double total = good + bad;
+  double p = good / total;
+  mean = sample * p;
+  var = total > 1 ? sample * p * (1 - p) * (total - sample) / (total - 1) : 0;
+}
+
+// Check the sample mean and variance of many hypergeometric draws
+static bool check_hypergeometric(uint64_t good, uint64_t bad, uint64_t sample)
+{
+  const uint64_t draws = 20000;
+  BS::default_engine rng(17);
+  double sum = 0;
+  double sum2 = 0;
+  for (uint64_t i = 0; i < draws; i++)
+  {
+    double x = static_cast<double>(BS::hypergeometric(rng, good, bad, sample));
+    sum += x;
+    sum2 += x * x;
+  }
+  double mean, var;
+  hyper_moments(good, bad, sample, mean, var);
+  double m = sum / draws;
+  double v = (sum2 - draws * m * m) / (draws - 1);
+  std::cout << "hypergeometric(" << good << ", " << bad << ", " << sample
+            << "):	mean " << m << " (" << mean << ")	variance " << v
+            << " (" << var << ")\n";
+  return std::fabs(m - mean) <= 5 * std::sqrt(var / draws) + 1e-9 &&
+         std::fabs(v - var) <= 0.05 * var + 1e-9;
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t N = std::stoul(argv[1]);
+    uint64_t n = std::stoul(argv[2]);
+    uint32_t threads = std::stoul(argv[3]);
+
+    std::vector<uint64_t> out(n);
+    BS::seed_random(11);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t written = BS::parallel_sample(N, n, out.data(), threads);
+    std::chrono::duration<double> t_par =
+      std::chrono::steady_clock::now() - start;
+
+    if (written != n)
+    {
+      std::cerr << "Sample size " << written << " != " << n << '\n';
+      return __LINE__;
+    }
+    for (uint64_t i = 0; i < n; i++)
+    {
+      if (out[i] >= N)
+      {
+        std::cerr << "Sample greater than population\n";
+        return __LINE__; // impossible
+      }
+      if (i > 0 && out[i] <= out[i - 1])
+      {
+        std::cerr << "Samples not strictly increasing\n";
+        return __LINE__; // unsorted or duplicate
+      }
+    }
+
+    // Every range holds a hypergeometric number of samples, within 6 standard
+    // deviations of the mean
+    uint32_t ranges = static_cast<uint32_t>(std::min<uint64_t>(threads, N));
+    uint64_t i = 0;
+    uint64_t lo = 0;
+    for (uint32_t t = 0; t < ranges; t++)
+    {
+      uint64_t size = N / ranges + (t < N % ranges ? 1 : 0);
+      uint64_t c = 0;
+      for (; i < n && out[i] < lo + size; i++)
+        c++;
+      double mean, var;
+      hyper_moments(size, N - size, n, mean, var);
+      if (std::fabs(c - mean) > 6 * std::sqrt(var) + 1e-9)
+      {
+        std::cerr << "Range " << t << " holds " << c << " samples, expected "
+                  << mean << " +- " << std::sqrt(var) << '\n';
+        return __LINE__;
+      }
+      lo += size;
+    }
+
+    // The draws for the range counts: inversion (HIN) for small samples, ratio
+    // of uniforms (HRUA) otherwise
+    uint64_t size0 = N / ranges + (N % ranges ? 1 : 0);
+    if (! check_hypergeometric(30, 70, 5) ||
+        ! check_hypergeometric(size0, N - size0, std::min<uint64_t>(n, 10)) ||
+        ! check_hypergeometric(size0, N - size0, n) ||
+        ! check_hypergeometric(1000, 1000000, 5000))
+    {
+      return __LINE__;
+    }
+
+    // Reproducible under the same seed
+    std::vector<uint64_t> again(n);
+    BS::seed_random(11);
+    BS::parallel_sample(N, n, again.data(), threads);
+    if (again != out)
+    {
+      return __LINE__;
+    }
+
+    start = std::chrono::steady_clock::now();
+    BS::vitter_d vd(N, n);
+    vd.fill(again.data(), n);
+    std::chrono::duration<double> t_seq =
+      std::chrono::steady_clock::now() - start;
+
+    std::cout << "sequential:\t" << static_cast<double>(n) / t_seq.count()
+              << " indices/sec\n";
+    std::cout << "parallel(" << threads << "):\t"
+              << static_cast<double>(n) / t_par.count() << " indices/sec\n";
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/describe.h"
+#include "../../src/parallel_stats.h"
+#include "../../src/random.h"
+
+static bool close(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    uint32_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+    const std::vector<double> probs {0, 0.05, 0.25, 0.5, 0.75, 0.95, 1};
+
+    BS::default_engine rng(11);
+    std::vector<double> data(n);
+    for (auto& x : data)
+      x = std::exp(4 * BS::uniform_open_unit(rng));
+
+    auto start = std::chrono::steady_clock::now();
+    BS::desc_stats<double> serial(data);
+    std::vector<double> sq = serial.quantiles(probs);
+    serial.sort();
+    std::chrono::duration<double> t_serial =
+      std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    BS::desc_stats<double> par =
+      BS::parallel_desc_stats(data.data(), n, threads);
+    std::chrono::duration<double> t_par =
+      std::chrono::steady_clock::now() - start;
+    std::cout << "serial:\t" << t_serial.count() << " s\n";
+    std::cout << "parallel (" << threads << " threads):\t" << t_par.count()
+              << " s\n";
+
+    // Full mode: same data, same order statistics, moments up to rounding
+    if (par.count() != n || par.min() != serial.min() ||
+        par.max() != serial.max() ||
+        ! close(par.mean(), serial.mean()) ||
+        ! close(par.variance(), serial.variance()) ||
+        ! close(par.skewness(), serial.skewness()) ||
+        ! close(par.kurtosis(), serial.kurtosis()))
+    {
+      std::cerr << par.mean() << '\t' << serial.mean() << '\n'
+                << par.variance() << '\t' << serial.variance() << '\n'
+                << par.skewness() << '\t' << serial.skewness() << '\n'
+                << par.kurtosis() << '\t' << serial.kurtosis() << '\n';
+      return __LINE__;
+    }
+    std::vector<double> pq = par.quantiles(probs);
+    for (uint64_t i = 0; i < probs.size(); i++)
+    {
+      if (pq[i] != sq[i])
+      {
+        return __LINE__;
+      }
+    }
+
+    // Online and sketch modes
+    BS::desc_stats<double> online =
+      BS::parallel_desc_stats(data.data(), n, threads, BS::stats_mode::online);
+    if (online.count() != n || ! close(online.stddev(), serial.stddev()))
+    {
+      return __LINE__;
+    }
+    BS::desc_stats<double> sketch =
+      BS::parallel_desc_stats(data.data(), n, threads, BS::stats_mode::sketch);
+    if (std::fabs(sketch.median() - serial.median()) >
+        0.01 * (serial.max() - serial.min()))
+    {
+      return __LINE__;
+    }
+
+    // Pairwise merges of sorted and unsorted parts
+    std::vector<double> a(data.begin(), data.begin() + n / 3);
+    std::vector<double> b(data.begin() + n / 3, data.end());
+    BS::desc_stats<double> da(a);
+    BS::desc_stats<double> db(b);
+    BS::desc_stats<double> ua(a);
+    da.sort();
+    db.sort();
+    da += db;
+    ua += db;
+    if (da.count() != n || ua.count() != n ||
+        ! close(da.variance(), serial.variance()) ||
+        ! close(ua.kurtosis(), serial.kurtosis()) ||
+        da.median() != serial.median() || ua.median() != serial.median())
+    {
+      return __LINE__;
+    }
+    try  // Should fail
+    {
+      da += online;
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+
+    // Histograms: the same counts as the serial constructors
+    BS::histogram<double> sh(data, 100);
+    BS::histogram<double> ph = BS::parallel_histogram(data.data(), n, 100,
+                                                      threads);
+    if (ph.const_counts() != sh.const_counts() ||
+        ph.const_breaks() != sh.const_breaks() || ph.max() != sh.max())
+    {
+      return __LINE__;
+    }
+    std::vector<double> clamped(data);
+    for (auto& x : clamped)
+      x = std::min(x, 50.0);
+    BS::histogram<double> sb(clamped, 1, 50, 7);
+    BS::histogram<double> pb = BS::parallel_histogram(clamped.data(), n, 1.0,
+                                                      50.0, 7, threads);
+    if (pb.const_counts() != sb.const_counts())
+    {
+      return __LINE__;
+    }
+    try  // Should fail, out of bounds
+    {
+      BS::parallel_histogram(data.data(), n, 0.0, 0.5, 7, threads);
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "../../src/radix_sort.h"
+#include "../../src/random.h"
+
+template <typename T>
+static bool check(std::vector<T> data, uint32_t threads)
+{
+  std::vector<T> expected(data);
+  std::sort(expected.begin(), expected.end());
+  BS::radix_sort(data.data(), data.size(), threads);
+  return data == expected;
+}
+
+template <typename T>
+static std::vector<T> random_ints(uint64_t n, BS::default_engine& rng)
+{
+  std::vector<T> data(n);
+  for (auto& x : data)
+    x = static_cast<T>(rng());
+  return data;
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    BS::default_engine rng(3);
+    const uint64_t sizes[] = {0, 1, 2, 17, 1000, 300001};
+    const uint32_t threads[] = {1, 2, 3, 8};
+    for (uint64_t n : sizes)
+    {
+      // Doubles over many magnitudes, both signs, with ties
+      std::vector<double> d(n);
+      for (uint64_t i = 0; i < n; i++)
+      {
+        double u = BS::uniform_open_unit(rng);
+        d[i] = (i % 2 ? -1 : 1) * std::exp(40 * u - 20);
+        if (i % 7 == 0) d[i] = std::floor(d[i]);
+      }
+      if (n > 10)
+      {
+        d[1] = std::numeric_limits<double>::infinity();
+        d[2] = -std::numeric_limits<double>::infinity();
+        d[3] = std::numeric_limits<double>::denorm_min();
+        d[4] = -std::numeric_limits<double>::max();
+        d[5] = 0.0;
+      }
+      std::vector<float> f(d.begin(), d.end());
+      std::vector<double> constant(n, 2.5);
+      for (uint32_t t : threads)
+      {
+        if (! check(d, t) || ! check(f, t) || ! check(constant, t) ||
+            ! check(random_ints<int64_t>(n, rng), t) ||
+            ! check(random_ints<uint64_t>(n, rng), t) ||
+            ! check(random_ints<int32_t>(n, rng), t) ||
+            ! check(random_ints<uint16_t>(n, rng), t) ||
+            ! check(random_ints<int8_t>(n, rng), t))
+        {
+          std::cerr << n << '\t' << t << '\n';
+          return __LINE__;
+        }
+      }
+    }
+    // Negative zero sorts before zero
+    std::vector<double> zeros {0.0, -0.0, 0.0, -0.0};
+    BS::radix_sort(zeros.data(), zeros.size());
+    if (! std::signbit(zeros[0]) || ! std::signbit(zeros[1]) ||
+        std::signbit(zeros[2]) || std::signbit(zeros[3]))
+    {
+      return __LINE__;
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
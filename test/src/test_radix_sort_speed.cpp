@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/radix_sort.h"
+#include "../../src/random.h"
+
+// Compare radix_sort against std::sort on doubles across sizes and thread
+// counts. Arguments: the largest size (sizes grow by 10x from 1000) and the
+// largest thread count (thread counts double from 1).
+int main(int argc, char ** argv)
+{
+  uint64_t max_n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+  uint32_t max_threads = argc > 2 ? std::stoul(argv[2]) : 8;
+  BS::default_engine rng(7);
+  std::cout << "n\tstd::sort";
+  for (uint32_t t = 1; t <= max_threads; t *= 2)
+    std::cout << "\tradix_" << t;
+  std::cout << "\t(seconds)\n";
+  for (uint64_t n = 1000; n <= max_n; n *= 10)
+  {
+    std::vector<double> data(n);
+    for (auto& x : data)
+      x = std::log(BS::uniform_open_unit(rng)) * 1000;
+    std::vector<double> work(data);
+    auto start = std::chrono::steady_clock::now();
+    std::sort(work.begin(), work.end());
+    std::chrono::duration<double> t_std =
+      std::chrono::steady_clock::now() - start;
+    std::vector<double> expected(work);
+    std::cout << n << '\t' << t_std.count();
+    for (uint32_t t = 1; t <= max_threads; t *= 2)
+    {
+      work = data;
+      start = std::chrono::steady_clock::now();
+      BS::radix_sort(work.data(), n, t);
+      std::chrono::duration<double> t_radix =
+        std::chrono::steady_clock::now() - start;
+      if (work != expected)
+      {
+        return __LINE__;
+      }
+      std::cout << '\t' << t_radix.count();
+    }
+    std::cout << '\n';
+  }
+  return 0;
+}
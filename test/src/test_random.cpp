@@ -0,0 +1,74 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../../src/random.h"
+#include "../../src/vitter_d.h"
+
+int main(int argc, char ** argv)
+{
+  // Same seed, same sequence
+  BS::seed_random(42);
+  uint64_t a = BS::thread_engine()();
+  BS::seed_random(42);
+  if (BS::thread_engine()() != a)
+  {
+    return __LINE__;
+  }
+
+  // Samplers without an explicit engine are reproducible after seeding
+  std::vector<uint64_t> first;
+  std::vector<uint64_t> second;
+  BS::seed_random(7);
+  BS::vitter_d vd1(1000000, 100);
+  while (! vd1.end()) first.push_back(vd1.next());
+  BS::seed_random(7);
+  BS::vitter_d vd2(1000000, 100);
+  while (! vd2.end()) second.push_back(vd2.next());
+  if (first != second)
+  {
+    return __LINE__;
+  }
+
+  // Split engines and streams differ from each other
+  BS::default_engine s1 = BS::split_engine();
+  BS::default_engine s2 = BS::split_engine();
+  if (s1() == s2())
+  {
+    return __LINE__;
+  }
+  BS::default_engine t0 = BS::stream_engine(42, 0);
+  BS::default_engine t1 = BS::stream_engine(42, 1);
+  BS::default_engine t1b = BS::stream_engine(42, 1);
+  uint64_t v1 = t1();
+  if (t0() == v1 || t1b() != v1)
+  {
+    return __LINE__;
+  }
+
+  // Each thread owns its engine
+  BS::seed_random(3);
+  uint64_t main_draw = BS::thread_engine()();
+  uint64_t other_draw = main_draw;
+  std::thread worker([&other_draw]() { other_draw = BS::thread_engine()(); });
+  worker.join();
+  if (other_draw == main_draw)
+  {
+    return __LINE__;
+  }
+
+  // Open unit interval
+  BS::default_engine rng(1);
+  BS::pcg32 rng32(1);
+  for (uint64_t i = 0; i < 1000000; i++)
+  {
+    double u = BS::uniform_open_unit(rng);
+    double u32 = BS::uniform_open_unit(rng32);
+    if (u < BS::LB() || u > BS::UB() || u32 < BS::LB() || u32 > BS::UB())
+    {
+      std::cerr << u << '\t' << u32 << '\n';
+      return __LINE__;
+    }
+  }
+
+  return 0;
+}
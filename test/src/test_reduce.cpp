@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "../../src/describe.h"
+#include "../../src/moments.h"
+#include "../../src/random.h"
+#include "../../src/reduce.h"
+
+static bool close(double a, long double b, double tol)
+{
+  return std::fabs(a - static_cast<double>(b)) <=
+         tol * std::max(1.0L, std::fabs(b));
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    // A large offset with small noise, hard for naive sums of squares
+    BS::default_engine rng(13);
+    std::vector<double> data(n);
+    for (auto& x : data)
+      x = 1e9 + std::log(BS::uniform_open_unit(rng));
+
+    // Two pass reference in long double
+    long double sum = 0;
+    for (double x : data) sum += x;
+    long double mean = sum / n;
+    long double m2 = 0;
+    long double m3 = 0;
+    long double m4 = 0;
+    for (double x : data)
+    {
+      long double d = x - mean;
+      m2 += d * d;
+      m3 += d * d * d;
+      m4 += d * d * d * d;
+    }
+
+    const char * names[] = {"scalar", "sse2", "avx2"};
+    BS::simd_level best = BS::best_simd_level();
+    std::cout << "best kernel:\t" << names[static_cast<int>(best)] << '\n';
+    for (int l = 0; l <= static_cast<int>(best); l++)
+    {
+      auto level = static_cast<BS::simd_level>(l);
+      auto start = std::chrono::steady_clock::now();
+      BS::reduce_result r = BS::reduce(data.data(), n, level);
+      std::chrono::duration<double> t =
+        std::chrono::steady_clock::now() - start;
+      std::cout << names[l] << ":\t" << n / t.count() << " values/sec\n";
+      if (r.count != n || ! close(r.sum(), sum, 1e-15) ||
+          ! close(r.mean(), mean, 1e-15) ||
+          ! close(r.central(2), m2, 1e-9) ||
+          ! close(r.central(3), m3, 1e-6) ||
+          ! close(r.central(4), m4, 1e-6))
+      {
+        std::cerr << r.sum() - sum << '\t' << r.central(2) - m2 << '\t'
+                  << r.central(3) - m3 << '\t' << r.central(4) - m4 << '\n';
+        return __LINE__;
+      }
+      double mn = data[0];
+      double mx = data[0];
+      for (double x : data)
+      {
+        mn = std::min(mn, x);
+        mx = std::max(mx, x);
+      }
+      if (r.min != mn || r.max != mx)
+      {
+        return __LINE__;
+      }
+    }
+
+    // Baselines: one pass Welford updates, and a plain accumulate
+    auto start = std::chrono::steady_clock::now();
+    BS::moments<double> welford;
+    for (double x : data) welford.add(x);
+    std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+    std::cout << "moments::add:\t" << n / t.count() << " values/sec\t"
+              << "variance error "
+              << welford.variance() - static_cast<double>(m2 / (n - 1)) << '\n';
+    start = std::chrono::steady_clock::now();
+    double naive = std::accumulate(data.begin(), data.end(), 0.0);
+    t = std::chrono::steady_clock::now() - start;
+    std::cout << "std::accumulate:\t" << n / t.count() << " values/sec\t"
+              << "sum error " << naive - static_cast<double>(sum) << '\n';
+
+    // desc_stats built from a vector uses the kernel
+    BS::desc_stats<double> desc(data);
+    if (! close(desc.sum(), sum, 1e-15) ||
+        ! close(desc.variance(), m2 / (n - 1), 1e-9))
+    {
+      return __LINE__;
+    }
+
+    // Values added one by one, and merged parts, keep the compensated sum
+    BS::desc_stats<double> online(BS::stats_mode::online);
+    BS::moments<double> left;
+    BS::moments<double> right;
+    for (uint64_t i = 0; i < n; i++)
+    {
+      online.add(data[i]);
+      (i < n / 3 ? left : right).add(data[i]);
+    }
+    left += right;
+    std::cout << "add() sum error:\t"
+              << online.sum() - static_cast<double>(sum) << '\n';
+    if (! close(online.sum(), sum, 1e-15) ||
+        ! close(online.mean(), mean, 1e-15) ||
+        ! close(left.sum(), sum, 1e-15) || ! close(left.mean(), mean, 1e-15))
+    {
+      std::cerr << online.sum() - sum << '\t' << left.sum() - sum << '\n';
+      return __LINE__;
+    }
+
+    // Tails shorter than a vector
+    for (uint64_t k = 1; k <= std::min<uint64_t>(n, 8); k++)
+    {
+      BS::reduce_result r = BS::reduce(data.data(), k);
+      BS::reduce_result s = BS::reduce(data.data(), k, BS::simd_level::scalar);
+      if (std::fabs(r.sum() - s.sum()) > 1e-15 * s.sum() || r.min != s.min ||
+          r.max != s.max)
+      {
+        return __LINE__;
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/reservoir.h"
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t N = std::stoul(argv[1]);
+    uint64_t k = std::stoul(argv[2]);
+    uint64_t reps = 20000;
+
+    // Every record should be kept with probability min(1, k / N)
+    std::vector<uint64_t> hits(N, 0);
+    for (uint64_t r = 0; r < reps; r++)
+    {
+      BS::reservoir_sample<uint64_t> rs(k);
+      for (uint64_t i = 0; i < N; i++)
+      {
+        // Bypass records the way a reader would
+        uint64_t s = rs.skip();
+        if (s > 0)
+        {
+          s = std::min(s, N - i);
+          rs.discard(s);
+          i += s - 1;
+          continue;
+        }
+        rs.add(i);
+      }
+      if (rs.seen() != N || rs.size() != std::min(k, N))
+      {
+        std::cerr << "Seen " << rs.seen() << ", kept " << rs.size() << '\n';
+        return __LINE__;
+      }
+      for (auto x : rs.const_sample())
+      {
+        if (x >= N)
+        {
+          std::cerr << "Sample greater than population\n";
+          return __LINE__; // impossible
+        }
+        hits[x]++;
+      }
+    }
+    double expected = std::min(1.0, static_cast<double>(k) / N);
+    for (uint64_t i = 0; i < N; i++)
+    {
+      double p = static_cast<double>(hits[i]) / reps;
+      // Binomial sd is at most 0.0036 for 20000 reps
+      if (std::fabs(p - expected) > 0.02)
+      {
+        std::cerr << "Record " << i << " kept with p = " << p << ", expected "
+                  << expected << '\n';
+        return __LINE__;
+      }
+    }
+
+    try // Should fail
+    {
+      BS::reservoir_sample<uint64_t> rs(k);
+      rs.discard(1);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
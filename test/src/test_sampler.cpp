@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/sampler.h"
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t N = std::stoul(argv[1]);
+    uint64_t n = std::stoul(argv[2]);
+    bool replace = argc > 3 && std::string(argv[3]) == "replace";
+
+    std::vector<BS::sample_method> methods;
+    if (replace)
+    {
+      methods = {BS::sample_method::replace_sorted,
+                 BS::sample_method::replace_stream};
+    }
+    else
+    {
+      methods = {BS::sample_method::vitter_d, BS::sample_method::bitmap};
+    }
+    // The automatic choice first, then every method explicitly
+    for (int m = -1; m < static_cast<int>(methods.size()); m++)
+    {
+      BS::sampler s = m < 0 ? BS::sampler(N, n, replace) :
+                              BS::sampler(N, n, methods[m]);
+      std::vector<uint64_t> buf(5);
+      uint64_t total = 0;
+      uint64_t prev = 0;
+      while (! s.end())
+      {
+        uint64_t written = s.fill(buf.data(), buf.size());
+        for (uint64_t i = 0; i < written; i++)
+        {
+          if (buf[i] >= N)
+          {
+            std::cerr << "Sample greater than population\n";
+            return __LINE__; // impossible
+          }
+          if (total > 0 && (buf[i] < prev || (! replace && buf[i] == prev)))
+          {
+            std::cerr << "Samples not in order\n";
+            return __LINE__;
+          }
+          prev = buf[i];
+          total++;
+        }
+      }
+      if (total != n)
+      {
+        std::cerr << "Sample size " << total << " != " << n << '\n';
+        return __LINE__;
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/sampler.h"
+
+// Reproduces the crossover points in sampler.h. Build with optimizations
+// (e.g. -DCMAKE_BUILD_TYPE=Release) for meaningful numbers.
+static uint64_t indices_per_run = 2000000;
+
+static double seconds_per_index(uint64_t N, uint64_t n, BS::sample_method m)
+{
+  std::vector<uint64_t> buf(4096);
+  uint64_t reps = std::max<uint64_t>(1, indices_per_run /
+                                        std::max<uint64_t>(n, 1));
+  auto start = std::chrono::steady_clock::now();
+  uint64_t total = 0;
+  for (uint64_t r = 0; r < reps; r++)
+  {
+    BS::sampler s(N, n, m);
+    while (! s.end())
+    {
+      total += s.fill(buf.data(), buf.size());
+    }
+  }
+  std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+  return t.count() / static_cast<double>(total);
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t N = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    if (argc > 2)
+      indices_per_run = std::stoul(argv[2]);
+
+    std::cout << "# Without replacement, N = " << N << '\n';
+    std::cout << "fraction\tvitter_d_ns\tbitmap_ns\tfaster\n";
+    double crossover = -1;
+    for (double f : {0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5,
+                     0.9})
+    {
+      uint64_t n = static_cast<uint64_t>(f * static_cast<double>(N));
+      double vd = seconds_per_index(N, n, BS::sample_method::vitter_d);
+      double bm = seconds_per_index(N, n, BS::sample_method::bitmap);
+      bool bitmap_faster = bm < vd;
+      if (bitmap_faster && crossover < 0)
+        crossover = f;
+      std::cout << f << '\t' << vd * 1e9 << '\t' << bm * 1e9 << '\t'
+                << (bitmap_faster ? "bitmap" : "vitter_d") << '\n';
+    }
+    std::cout << "# SAMPLER_BITMAP_FRACTION ~ " << crossover << "\n\n";
+
+    std::cout << "# With replacement, N = " << N << '\n';
+    std::cout << "n\tsorted_ns\tstream_ns\tfaster\n";
+    uint64_t min_stream = 0;
+    for (uint64_t n = 16; n <= (1 << 20); n *= 4)
+    {
+      double so = seconds_per_index(N, n, BS::sample_method::replace_sorted);
+      double st = seconds_per_index(N, n, BS::sample_method::replace_stream);
+      if (st < so && min_stream == 0)
+        min_stream = n;
+      std::cout << n << '\t' << so * 1e9 << '\t' << st * 1e9 << '\t'
+                << (st < so ? "stream" : "sorted") << '\n';
+    }
+    std::cout << "# SAMPLER_STREAM_MIN_N ~ " << min_stream << '\n';
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include "../../src/simple_sample.h"
 #include <iostream>
@@ -8,8 +9,10 @@ int main(int argc, char ** argv)
   {
     uint64_t N = std::stoul(argv[1]);
     uint64_t n = std::stoul(argv[2]);
-    BS::simple_sample<uint32_t> ss(N, n);
+    BS::simple_sample<uint64_t> ss(N, n);
 
+    uint64_t total = 0;
+    uint64_t max = 0;
     while (! ss.end())
     {
       uint64_t cur = ss.next();
@@ -19,6 +22,61 @@ int main(int argc, char ** argv)
         std::cerr << "Sample greater than population\n";
         return __LINE__; // impossible
       }
+      max = std::max(max, cur);
+      total++;
+    }
+    if (total != n)
+    {
+      std::cerr << "Sample size " << total << " != " << n << '\n';
+      return __LINE__;
+    }
+    // With N well above 2^32 some index must be above it, unless the indices
+    // were drawn with 32 bits
+    const uint64_t two32 = 1ULL << 32;
+    if (N >= 4 * two32 && n >= 1000 && max < two32)
+    {
+      std::cerr << "No sample above 2^32 in a population of " << N << '\n';
+      return __LINE__;
+    }
+
+    // Streaming mode, 64 bit population
+    BS::simple_sample<uint64_t> st(N, n, true);
+    uint64_t prev = 0;
+    total = 0;
+    while (! st.end())
+    {
+      uint64_t cur = st.next();
+      if (cur >= N)
+      {
+        std::cerr << "Streamed sample greater than population\n";
+        return __LINE__; // impossible
+      }
+      if (cur < prev)
+      {
+        std::cerr << "Streamed samples not sorted\n";
+        return __LINE__;
+      }
+      prev = cur;
+      total++;
+    }
+    if (total != n)
+    {
+      std::cerr << "Streamed sample size " << total << " != " << n << '\n';
+      return __LINE__;
+    }
+
+    // Character types are drawn through 64 bit integers
+    BS::simple_sample<unsigned char> sc(200, 50);
+    unsigned char prev_c = 0;
+    while (! sc.end())
+    {
+      unsigned char cur = sc.next();
+      if (cur >= 200 || cur < prev_c)
+      {
+        std::cerr << "Bad character sample " << static_cast<int>(cur) << '\n';
+        return __LINE__;
+      }
+      prev_c = cur;
     }
   }
   catch (std::exception& e)
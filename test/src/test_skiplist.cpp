@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "../../src/describe.h"
+#include "../../src/random.h"
+#include "../../src/skiplist.h"
+
+// Compare every rank and the iteration order against a sorted vector
+static bool same(const BS::skiplist<int>& list, const std::vector<int>& ref)
+{
+  if (list.size() != ref.size())
+    return false;
+  for (uint64_t i = 0; i < ref.size(); i++)
+  {
+    if (list.at(i) != ref[i])
+      return false;
+  }
+  return std::equal(ref.begin(), ref.end(), list.begin());
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    BS::seed_random(17);
+    BS::default_engine rng(17);
+    BS::skiplist<int> list;
+    std::vector<int> ref;
+    // Random inserts and erases with many duplicates
+    for (int round = 0; round < 20000; round++)
+    {
+      int x = static_cast<int>(rng() % 500);
+      if (rng() % 3 == 0)
+      {
+        auto it = std::lower_bound(ref.begin(), ref.end(), x);
+        bool found = it != ref.end() && *it == x;
+        if (found)
+          ref.erase(it);
+        if (list.erase(x) != found)
+        {
+          return __LINE__;
+        }
+      }
+      else
+      {
+        ref.insert(std::upper_bound(ref.begin(), ref.end(), x), x);
+        list.insert(x);
+      }
+      if (round % 1000 == 0 && ! same(list, ref))
+      {
+        return __LINE__;
+      }
+    }
+    if (! same(list, ref))
+    {
+      return __LINE__;
+    }
+
+    // Copies are independent
+    BS::skiplist<int> copy(list);
+    copy.insert(-1);
+    if (! same(list, ref) || copy.at(0) != -1 || copy.size() != ref.size() + 1)
+    {
+      return __LINE__;
+    }
+    BS::skiplist<int> moved(std::move(copy));
+    if (moved.size() != ref.size() + 1 || ! copy.empty())
+    {
+      return __LINE__;
+    }
+    copy = list;
+    if (! same(copy, ref))
+    {
+      return __LINE__;
+    }
+
+    // Drain
+    for (int x : ref)
+    {
+      if (! list.erase(x))
+      {
+        return __LINE__;
+      }
+    }
+    if (! list.empty() || list.erase(1))
+    {
+      return __LINE__;
+    }
+    try  // Should fail
+    {
+      list.at(0);
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+
+    // Lists and stats objects leave the library random state alone
+    BS::seed_random(23);
+    uint64_t expected = BS::thread_engine()();
+    BS::seed_random(23);
+    {
+      BS::skiplist<double> other;
+      other.insert(1);
+      BS::desc_stats<double> full;
+      BS::desc_stats<double> indexed(BS::stats_mode::indexed);
+      indexed.add(2);
+      BS::desc_stats<double> copy(indexed);
+      if (copy.median() != 2)
+      {
+        return __LINE__;
+      }
+    }
+    if (BS::thread_engine()() != expected)
+    {
+      return __LINE__;
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/describe.h"
+#include "../../src/random.h"
+#include "../../src/tdigest.h"
+
+// Rank error of an estimate against sorted data. Estimates inside a run of
+// equal values get the closest rank of that run.
+static double rank_error(const std::vector<double>& sorted, double v, double q)
+{
+  double n = static_cast<double>(sorted.size());
+  double lo = std::lower_bound(sorted.begin(), sorted.end(), v) -
+              sorted.begin();
+  double hi = std::upper_bound(sorted.begin(), sorted.end(), v) -
+              sorted.begin();
+  double r = q * (n - 1);
+  if (r < lo) return (lo - r) / n;
+  if (r > hi) return (r - hi) / n;
+  return 0;
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    double compression = argc > 2 ? std::stod(argv[2]) : 200;
+    // The exact reference needs all values in memory
+    bool exact = n <= 100000000;
+    uint64_t parts = 4;
+    const double qs[] = {0.001, 0.01, 0.05, 0.1, 0.25, 0.5, 0.75, 0.9, 0.95,
+                         0.99, 0.999};
+
+    BS::default_engine rng(5);
+    BS::desc_stats<double> sketch(BS::stats_mode::sketch, compression);
+    std::vector<BS::tdigest> shards(parts, BS::tdigest(compression));
+    std::vector<double> data;
+    if (exact)
+      data.reserve(n);
+
+    std::chrono::duration<double> t_add(0);
+    for (uint64_t i = 0; i < n; i++)
+    {
+      // Skewed data: a mixture of an exponential and a uniform
+      double u = BS::uniform_open_unit(rng);
+      double x = i % 3 == 0 ? 100.0 * u : -10.0 * std::log(u);
+      auto start = std::chrono::steady_clock::now();
+      sketch.add(x);
+      t_add += std::chrono::steady_clock::now() - start;
+      shards[i % parts].add(x);
+      if (exact)
+        data.push_back(x);
+    }
+    BS::tdigest merged(compression);
+    for (const auto& s : shards)
+      merged.merge(s);
+
+    std::cout << "values:\t" << n << '\n';
+    std::cout << "compression:\t" << compression << '\n';
+    std::cout << "centroids:\t" << merged.centroids() << '\n';
+    std::cout << "memory_bytes:\t" << merged.memory_bytes() << '\n';
+    std::cout << "desc_stats(sketch) add:\t"
+              << static_cast<double>(n) / t_add.count() << " values/sec\n";
+
+    if (! exact)
+    {
+      std::cout << "# exact reference skipped above 10^8 values\n";
+      return 0;
+    }
+
+    BS::desc_stats<double> full(data);
+    std::sort(data.begin(), data.end());
+    double max_err = 0;
+    std::cout << "q\texact\tsketch\trank_err\tmerged\trank_err\n";
+    for (double q : qs)
+    {
+      double e = full.quantile(q);
+      double s = sketch.quantile(q);
+      double m = merged.quantile(q);
+      double es = rank_error(data, s, q);
+      double em = rank_error(data, m, q);
+      max_err = std::max(max_err, std::max(es, em));
+      std::cout << q << '\t' << e << '\t' << s << '\t' << es << '\t' << m
+                << '\t' << em << '\n';
+    }
+    std::cout << "max_rank_error:\t" << max_err << '\n';
+    if (max_err > 2.0 / compression)
+    {
+      return __LINE__;
+    }
+
+    // Type 7 for all-singleton digests
+    std::vector<double> small {3, 1, 2, 5, 4};
+    BS::desc_stats<double> small_exact(small);
+    BS::tdigest small_digest(compression);
+    for (double x : small) small_digest.add(x);
+    for (double q : qs)
+    {
+      if (std::fabs(small_exact.quantile(q) - small_digest.quantile(q)) > 1e-12)
+      {
+        return __LINE__;
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
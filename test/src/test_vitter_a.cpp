@@ -1,5 +1,6 @@
 #include <string>
 #include <unordered_set>
+#include <vector>
 #include "../../src/vitter_a.h"
 #include <iostream>
 
@@ -29,6 +30,36 @@ int main(int argc, char ** argv)
       }
       gens.insert(cur);
     }
+
+    // Batched interface, with a buffer size that does not divide n
+    BS::vitter_a vb(N, n);
+    std::vector<uint64_t> buf(7);
+    uint64_t total = 0;
+    uint64_t prev = 0;
+    while (! vb.end())
+    {
+      uint64_t written = vb.fill(buf.data(), buf.size());
+      for (uint64_t i = 0; i < written; i++)
+      {
+        if (buf[i] >= N)
+        {
+          std::cerr << "Batched sample greater than population\n";
+          return __LINE__; // impossible
+        }
+        if (total > 0 && buf[i] <= prev)
+        {
+          std::cerr << "Batched samples not strictly increasing\n";
+          return __LINE__; // unsorted or duplicate
+        }
+        prev = buf[i];
+        total++;
+      }
+    }
+    if (total != n)
+    {
+      std::cerr << "Batched sample size " << total << " != " << n << '\n';
+      return __LINE__;
+    }
   }
   catch (std::exception& e)
   {
@@ -1,5 +1,7 @@
 #include "../../src/vitter_d.h"
+#include <chrono>
 #include <iostream>
+#include <vector>
 
 int main(int argc, char ** argv)
 {
@@ -7,12 +9,50 @@ int main(int argc, char ** argv)
   {
     uint64_t N = std::stoul(argv[1]);
     uint64_t n = std::stoul(argv[2]);
-    BS::vitter_d vd(N, n);
+    uint64_t batch = argc > 3 ? std::stoul(argv[3]) : 4096;
 
+    // Per-call path
+    auto start = std::chrono::steady_clock::now();
+    BS::vitter_d vd(N, n);
+    uint64_t checksum_call = 0;
     while (! vd.end())
     {
-      vd.next();
+      checksum_call += vd.next();
+    }
+    std::chrono::duration<double> t_call =
+      std::chrono::steady_clock::now() - start;
+
+    // Batched path
+    start = std::chrono::steady_clock::now();
+    BS::vitter_d vb(N, n);
+    std::vector<uint64_t> buf(batch);
+    uint64_t checksum_batch = 0;
+    uint64_t total = 0;
+    while (! vb.end())
+    {
+      uint64_t written = vb.fill(buf.data(), buf.size());
+      for (uint64_t i = 0; i < written; i++)
+      {
+        checksum_batch += buf[i];
+      }
+      total += written;
     }
+    std::chrono::duration<double> t_batch =
+      std::chrono::steady_clock::now() - start;
+
+    if (total != n)
+    {
+      std::cerr << "Batched sample size " << total << " != " << n << '\n';
+      return __LINE__;
+    }
+
+    std::cout << "next():\t" << static_cast<double>(n) / t_call.count()
+              << " indices/sec\n";
+    std::cout << "fill(" << batch << "):\t"
+              << static_cast<double>(n) / t_batch.count()
+              << " indices/sec\n";
+    // Keep the optimizer from dropping either loop
+    std::cerr << checksum_call << '\t' << checksum_batch << '\n';
   }
   catch (std::exception& e)
   {
@@ -20,4 +60,4 @@ int main(int argc, char ** argv)
     return __LINE__;
   }
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/weighted_reservoir.h"
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t N = 10;
+    uint64_t reps = 100000;
+
+    // With k = 1 record i is kept with probability w_i / sum(w)
+    std::vector<double> hits(N, 0);
+    double total = 0;
+    for (uint64_t i = 0; i < N; i++)
+    {
+      total += i;
+    }
+    for (uint64_t r = 0; r < reps; r++)
+    {
+      BS::weighted_reservoir_sample<uint64_t> wrs(1);
+      for (uint64_t i = 0; i < N; i++)
+      {
+        wrs.add(i, static_cast<double>(i));
+      }
+      if (wrs.size() != 1 || wrs.seen() != N)
+      {
+        return __LINE__;
+      }
+      hits[wrs.sample()[0]]++;
+    }
+    for (uint64_t i = 0; i < N; i++)
+    {
+      double p = hits[i] / reps;
+      double expected = static_cast<double>(i) / total;
+      if (std::fabs(p - expected) > 0.005)
+      {
+        std::cerr << "Record " << i << " kept with p = " << p << ", expected "
+                  << expected << '\n';
+        return __LINE__;
+      }
+    }
+
+    // Larger reservoir, every record must appear at most once
+    BS::weighted_reservoir_sample<uint64_t> wrs(100);
+    for (uint64_t i = 0; i < 1000000; i++)
+    {
+      wrs.add(i, 1.0 + static_cast<double>(i % 7));
+    }
+    std::vector<uint64_t> samp = wrs.sample();
+    std::sort(samp.begin(), samp.end());
+    if (samp.size() != 100 ||
+        std::adjacent_find(samp.begin(), samp.end()) != samp.end())
+    {
+      return __LINE__;
+    }
+
+    try // Should fail
+    {
+      wrs.add(0, -1);
+      return __LINE__;
+    }
+    catch (std::exception& e)
+    {
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../src/random.h"
+#include "../../src/weighted_reservoir.h"
+
+// Naive weighted reservoir (algorithm A-Res): one key per record
+static std::vector<uint64_t> naive_sample(const std::vector<double>& weights,
+                                          uint64_t k, BS::default_engine& rng)
+{
+  typedef std::pair<double, uint64_t> entry_t;
+  std::vector<entry_t> heap;
+  std::greater<entry_t> gt;
+  for (uint64_t i = 0; i < weights.size(); i++)
+  {
+    double key = std::log(BS::uniform_open_unit(rng)) / weights[i];
+    if (heap.size() < k)
+    {
+      heap.emplace_back(key, i);
+      std::push_heap(heap.begin(), heap.end(), gt);
+    }
+    else if (key > heap.front().first)
+    {
+      std::pop_heap(heap.begin(), heap.end(), gt);
+      heap.back() = entry_t(key, i);
+      std::push_heap(heap.begin(), heap.end(), gt);
+    }
+  }
+  std::vector<uint64_t> ret;
+  for (const auto& e : heap)
+    ret.push_back(e.second);
+  return ret;
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    uint64_t N = std::stoul(argv[1]);
+    uint64_t k = std::stoul(argv[2]);
+
+    BS::default_engine rng(1);
+    std::vector<double> weights(N);
+    for (auto& w : weights)
+    {
+      w = 1.0 + 100.0 * BS::uniform_open_unit(rng);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> naive = naive_sample(weights, k, rng);
+    std::chrono::duration<double> t_naive =
+      std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    BS::weighted_reservoir_sample<uint64_t> wrs(k, rng);
+    for (uint64_t i = 0; i < N; i++)
+    {
+      wrs.add(i, weights[i]);
+    }
+    std::chrono::duration<double> t_expj =
+      std::chrono::steady_clock::now() - start;
+
+    if (wrs.size() != std::min(N, k) || naive.size() != wrs.size())
+    {
+      return __LINE__;
+    }
+
+    std::cout << "A-Res:\t" << static_cast<double>(N) / t_naive.count()
+              << " records/sec\n";
+    std::cout << "A-ExpJ:\t" << static_cast<double>(N) / t_expj.count()
+              << " records/sec\n";
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,163 @@
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "../../src/describe.h"
+#include "../../src/random.h"
+#include "../../src/window_stats.h"
+
+// Compare against desc_stats over a copy of the window
+static bool check(BS::window_stats<double>& ws, const std::deque<double>& ref)
+{
+  if (ws.size() != ref.size())
+    return false;
+  std::vector<double> v(ref.begin(), ref.end());
+  BS::desc_stats<double> d(v);
+  double scale = std::max(1.0, std::fabs(d.mean()));
+  if (std::fabs(ws.mean() - d.mean()) > 1e-9 * scale ||
+      ws.min() != d.min() || ws.max() != d.max())
+    return false;
+  if (v.size() > 1 &&
+      std::fabs(ws.variance() - d.variance()) > 1e-6 * d.variance())
+    return false;
+  const double probs[] = {0, 0.1, 0.25, 0.5, 0.9, 0.99, 1};
+  for (double q : probs)
+  {
+    if (std::fabs(ws.quantile(q) - d.quantile(q)) > 1e-9 * scale)
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, char ** argv)
+{
+  try
+  {
+    BS::default_engine rng(23);
+    // Count window
+    BS::window_stats<double> ws(100);
+    std::deque<double> ref;
+    for (uint64_t i = 0; i < 5000; i++)
+    {
+      double x = std::floor(1000 * BS::uniform_open_unit(rng)) + 1e6;
+      ws.add(x);
+      ref.push_back(x);
+      if (ref.size() > 100)
+        ref.pop_front();
+      if (i % 37 == 0 && ! check(ws, ref))
+      {
+        std::cerr << i << '\n';
+        return __LINE__;
+      }
+    }
+
+    // Time window, with irregular arrivals
+    BS::window_stats<double> wt(1000000, 10.0);
+    std::deque<std::pair<double, double>> tref;
+    double t = 0;
+    for (uint64_t i = 0; i < 5000; i++)
+    {
+      t += -std::log(BS::uniform_open_unit(rng));
+      double x = std::sin(t) * 100;
+      wt.add(x, t);
+      tref.push_back(std::make_pair(t, x));
+      while (t - tref.front().first > 10.0)
+        tref.pop_front();
+      if (i % 41 == 0)
+      {
+        std::deque<double> values;
+        for (auto& p : tref) values.push_back(p.second);
+        if (! check(wt, values))
+        {
+          return __LINE__;
+        }
+      }
+    }
+    wt.expire(t + 100);
+    if (wt.size() != 0)
+    {
+      return __LINE__;
+    }
+    try  // Should fail
+    {
+      wt.min();
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+
+    // Without quantiles
+    BS::window_stats<int> wi(3, std::numeric_limits<double>::infinity(),
+                             false);
+    for (int x : {5, 1, 4, 2, 3})
+      wi.add(x);
+    if (wi.min() != 2 || wi.max() != 4 || wi.mean() != 3)
+    {
+      return __LINE__;
+    }
+    try  // Should fail
+    {
+      wi.median();
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+
+    // Copies own their sorted values
+    BS::window_stats<int> wq(3);
+    for (int x : {5, 1, 4, 2, 3})
+      wq.add(x);
+    BS::window_stats<int> wc(wq);
+    wq.add(9);
+    if (wc.median() != 3 || wq.median() != 3 || wc.max() != 4)
+    {
+      return __LINE__;
+    }
+    wc = wi;
+    try  // Should fail
+    {
+      wc.median();
+      return __LINE__;
+    }
+    catch(std::exception& e)
+    {
+    }
+
+    // No drift over a long stream with a large offset and small variance
+    BS::window_stats<double> wl(1000, std::numeric_limits<double>::infinity(),
+                                false);
+    for (uint64_t i = 0; i < 10000000; i++)
+      wl.add(1e9 + 1e-3 * BS::uniform_open_unit(rng));
+    std::vector<double> last;
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+      double x = 1e9 + 1e-3 * BS::uniform_open_unit(rng);
+      wl.add(x);
+      last.push_back(x);
+    }
+    double mean = 0;
+    for (double x : last)
+      mean += x - 1e9;
+    mean /= last.size();
+    double m2 = 0;
+    for (double x : last)
+      m2 += (x - 1e9 - mean) * (x - 1e9 - mean);
+    double var = m2 / (last.size() - 1);
+    if (std::fabs(wl.mean() - 1e9 - mean) > 1e-6 ||
+        std::fabs(wl.variance() - var) > 1e-2 * var)
+    {
+      std::cerr << wl.mean() - 1e9 - mean << ' ' << wl.variance() << ' '
+                << var << '\n';
+      return __LINE__;
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return __LINE__;
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/random.h"
+#include "../../src/window_stats.h"
+
+// Updates per second of window_stats for a range of window sizes, with and
+// without quantiles. Arguments: the number of updates per run and the
+// largest window size (sizes grow by 10x from 100).
+int main(int argc, char ** argv)
+{
+  uint64_t updates = argc > 1 ? std::stoul(argv[1]) : 10000000;
+  uint64_t max_window = argc > 2 ? std::stoul(argv[2]) : 1000000;
+  BS::default_engine rng(29);
+  std::vector<double> data(updates);
+  for (auto& x : data)
+    x = -std::log(BS::uniform_open_unit(rng)) * 20;
+  std::cout << "window\tmoments+minmax\t+quantiles\t(updates/sec)\n";
+  for (uint64_t w = 100; w <= max_window; w *= 10)
+  {
+    std::cout << w;
+    for (bool quantiles : {false, true})
+    {
+      BS::window_stats<double> ws(w, std::numeric_limits<double>::infinity(),
+                                  quantiles);
+      double check = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < updates; i++)
+      {
+        ws.add(data[i]);
+        // A query every 1000 updates, as a dashboard would
+        if (i % 1000 == 999)
+          check += ws.mean() + ws.max() + (quantiles ? ws.quantile(0.99) : 0);
+      }
+      std::chrono::duration<double> t =
+        std::chrono::steady_clock::now() - start;
+      std::cout << '\t' << updates / t.count();
+      if (std::isnan(check))
+      {
+        return __LINE__;
+      }
+    }
+    std::cout << '\n';
+  }
+  return 0;
+}